@@ -21,13 +21,31 @@
 #include <QScrollBar>
 
 MainWindow::MainWindow(QWidget * parent)
-	: QMainWindow(parent), storage(platform_utils::get_repo_path())
+	: QMainWindow(parent), storage(platform_utils::get_repo_path()), parse_cache_(storage.data_path() / "parse_cache")
 {
 	ui.setupUi(this);
 
+	// 清理源文件已删除或已修改、或解析策略已不存在的解析缓存: 要逐个读取条目头部，放到后台线程，不拖慢启动
+	// 与加载并行也无妨: 只删除加载时本就不会命中的条目
+	std::unordered_set<size_t> live_strategies{ parser_strategy::get_default().hash() };
+	for (const auto& name : storage.get_parser_strategy_names()) {
+		if (auto strategy = storage.get_parser_strategy(name)) live_strategies.insert(strategy->hash());
+	}
+	cache_cleanup_ = std::jthread([this, live_strategies = std::move(live_strategies)](std::stop_token stop)
+		{
+			parse_cache_.evict_stale(live_strategies, stop);
+		});
+
 	// 立即应用主题
 	applyTheme(storage.config().dark_mode);
 
+	// 记录都由后台写盘线程写入: 退出或切到后台 (Android 上随后可能被系统结束) 时等它写完
+	connect(qApp, &QCoreApplication::aboutToQuit, this, [this]() { storage.flush(); });
+	connect(qApp, &QGuiApplication::applicationStateChanged, this, [this](Qt::ApplicationState state)
+		{
+			if(state == Qt::ApplicationSuspended || state == Qt::ApplicationHidden) storage.flush();
+		});
+
 	// 创建并嵌入 HomePage
 	homePage_ = new HomePage(this);
 	ui.layout_HomeContainer->addWidget(homePage_);
@@ -156,8 +174,20 @@ MainWindow::MainWindow(QWidget * parent)
         ui.stackedWidget->setCurrentWidget(ui.page_Home);
     });
 
+    // 历史分页: 从已显示的条数之后继续读下一页
+    connect(historyPage_, &HistoryPage::loadMoreClicked, this, [this]() {
+        auto repo = homePage_->comboRepo()->currentText().toStdString();
+        auto records = storage.get_history(repo, history_loaded_, history_page_size);
+        history_loaded_ += records.size();
+        historyPage_->appendHistory(records);
+        historyPage_->setHasMore(history_loaded_ < storage.get_history_count(repo));
+    });
+
     // 返回按钮 (ExamConfig -> Home) - 委托给 ExamConfigPage
     connect(examConfigPage_, &ExamConfigPage::backClicked, this, [this]() {
+        // 不考试了: 释放视图 (解除文件映射)
+        exam_views_ = {};
+        exam_selection_.clear();
         ui.stackedWidget->setCurrentWidget(ui.page_Home);
     });
 
@@ -198,50 +228,21 @@ MainWindow::MainWindow(QWidget * parent)
         practiceStrategyPage_->loadStrategy(strategy);
         practiceStrategyPage_->setRepoName(repoName);
 
-        // 自动扫描并加载统计
-        std::vector<std::string> checked_paths;
-        for (auto* item : selected_items) {
-            checked_paths.push_back(item->data(Qt::UserRole).toString().toStdString());
-        }
-
-        // 根据用户选择的策略创建解析器
-        QString strategyName = homePage_->comboParser()->currentData().toString();
-        text_parser parser;
-        if (!strategyName.isEmpty()) {
-            auto parserStrategy = storage.get_parser_strategy(strategyName.toStdString());
-            if (parserStrategy) {
-                parser = text_parser(*parserStrategy);
-            }
-        }
-
-        std::vector<question> questions;
-        for (const auto& path : checked_paths) {
-            QFile file(QString::fromStdString(path));
-            if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-                QTextStream in(&file);
-                in.setEncoding(QStringConverter::Utf8);
-                QString content = in.readAll();
-                std::string std_content = content.toStdString();
-                
-                std::string filename = path;
-                size_t last_slash = filename.find_last_of("/\\");
-                if (last_slash != std::string::npos) {
-                    filename = filename.substr(last_slash + 1);
-                }
-                
-                auto qs = parser.parse(std_content, filename);
-                questions.insert(questions.end(), std::make_move_iterator(qs.begin()), std::make_move_iterator(qs.end()));
-                file.close();
+        // 自动扫描并加载统计 (后台多文件并行只读扫描，不生成题目)
+        view_selected_async([this](question_view_list views, bank_index index) {
+            if (views.empty()) {
+                QMessageBox::warning(this, "提示", "文件里无题目！");
+                return;
             }
-        }
 
-        if (questions.empty()) {
-            QMessageBox::warning(this, "提示", "文件里无题目！");
-            return;
-        }
+            practiceStrategyPage_->loadStatistics(index.summarize());
+            ui.stackedWidget->setCurrentWidget(ui.page_PracticeStrategy);
+        });
+    });
 
-        practiceStrategyPage_->loadStatistics(questions);
-        ui.stackedWidget->setCurrentWidget(ui.page_PracticeStrategy);
+    // 取消后台加载
+    connect(homePage_, &HomePage::cancelLoading, this, [this]() {
+        if (load_task_) load_task_->cancel();
     });
 
     connect(practiceStrategyPage_, &PracticeStrategyPage::backClicked, this, [this]() {
@@ -255,6 +256,11 @@ MainWindow::MainWindow(QWidget * parent)
     // 考试配置页 -> 开始考试
     connect(examConfigPage_, &ExamConfigPage::startExam, this, [this](const std::array<size_t, 4>& counts, [[maybe_unused]] const std::array<double, 4>& scores, [[maybe_unused]] int duration) {
         
+        // 此时才把选中的题目生成出来，随后释放视图 (解除文件映射)
+        begin_session(exam_views_.materialize(exam_selection_));
+        exam_views_ = {};
+        exam_selection_.clear();
+
         exam_start_time_ = std::chrono::steady_clock::now();
         
         // 传递处理函数
@@ -313,6 +319,28 @@ MainWindow::MainWindow(QWidget * parent)
 			}
 		});
 
+	connect(settingsPage_, &SettingsPage::exportMistakesClicked, this, [this]()
+		{
+			QString path = QFileDialog::getSaveFileName(this, "导出错题记录", "mistakes.json", "JSON (*.json)");
+			if(path.isEmpty()) return;
+
+			if(storage.export_mistakes(platform_utils::to_fs_path(path)))
+				QMessageBox::information(this, "提示", "错题记录已导出。");
+			else
+				QMessageBox::warning(this, "提示", "导出失败，无法写入文件！");
+		});
+
+	connect(settingsPage_, &SettingsPage::exportHistoryClicked, this, [this]()
+		{
+			QString path = QFileDialog::getSaveFileName(this, "导出考试历史", "history.json", "JSON (*.json)");
+			if(path.isEmpty()) return;
+
+			if(storage.export_history(platform_utils::to_fs_path(path)))
+				QMessageBox::information(this, "提示", "考试历史已导出。");
+			else
+				QMessageBox::warning(this, "提示", "导出失败，无法写入文件！");
+		});
+
 	// 保存设置
 	connect(settingsPage_, &SettingsPage::saveClicked, this, [this]()
 		{
@@ -359,51 +387,58 @@ MainWindow::MainWindow(QWidget * parent)
 	// HomePage -> 顺序练习
 	connect(homePage_, &HomePage::startSequentialPractice, this, [this]()
 		{
-			if(!init_start()) return;
-			is_exam_mode_ = false;
-			is_view_mode_ = false;
-			exam_timer_->stop();
-			ui.lbl_ExamTimer->hide();
-			ui.btnSubmitAnswer->show();
-			process([](auto group) { return group; });
-			ui.stackedWidget->setCurrentWidget(ui.page_Quiz);
-			show_question(0);
+			init_start([this]()
+				{
+					is_exam_mode_ = false;
+					is_view_mode_ = false;
+					exam_timer_->stop();
+					ui.lbl_ExamTimer->hide();
+					ui.btnSubmitAnswer->show();
+					process([](auto group) { return group; });
+					ui.stackedWidget->setCurrentWidget(ui.page_Quiz);
+					show_question(0);
+				});
 		});
 
 	// HomePage -> 乱序练习
 	connect(homePage_, &HomePage::startRandomPractice, this, [this]()
 		{
-			if(!init_start()) return;
-			is_exam_mode_ = false;
-			is_view_mode_ = false;
-			exam_timer_->stop();
-			ui.lbl_ExamTimer->hide();
-			ui.btnSubmitAnswer->show();
-			process([](auto group) { return group; }, true);
-			ui.stackedWidget->setCurrentWidget(ui.page_Quiz);
-			show_question(0);
+			init_start([this]()
+				{
+					is_exam_mode_ = false;
+					is_view_mode_ = false;
+					exam_timer_->stop();
+					ui.lbl_ExamTimer->hide();
+					ui.btnSubmitAnswer->show();
+					process([](auto group) { return group; }, true);
+					ui.stackedWidget->setCurrentWidget(ui.page_Quiz);
+					show_question(0);
+				});
 		});
 
 	// HomePage -> 看题模式
 	connect(homePage_, &HomePage::startViewMode, this, [this]()
 		{
-			if(!init_start()) return;
-			is_exam_mode_ = false;
-			is_view_mode_ = true;
-			exam_timer_->stop();
-			ui.lbl_ExamTimer->hide();
-			ui.btnSubmitAnswer->hide();  // 隐藏提交按钮
-			process([](auto group) { return group; }, true);
+			init_start([this]()
+				{
+					is_exam_mode_ = false;
+					is_view_mode_ = true;
+					exam_timer_->stop();
+					ui.lbl_ExamTimer->hide();
+					ui.btnSubmitAnswer->hide();  // 隐藏提交按钮
+					process([](auto group) { return group; }, true);
 			
-			// 将所有题目标记为已正确回答
-			for (size_t i = 0; i < curr_questions_.size(); ++i)
-			{
-				curr_results_[i] = answer_state::correct;
-				user_answers_[i] = to_QString(curr_questions_[i].correct_answer);
-			}
+					// 将所有题目标记为已正确回答
+					for (size_t i = 0; i < curr_questions_.size(); ++i)
+					{
+						curr_results_[i] = answer_state::correct;
+						user_answers_[i] = to_QString(curr_questions_[i].correct_answer);
+						user_selections_[i] = curr_questions_[i].answer_mask;
+					}
 			
-			ui.stackedWidget->setCurrentWidget(ui.page_Quiz);
-			show_question(0);
+					ui.stackedWidget->setCurrentWidget(ui.page_Quiz);
+					show_question(0);
+				});
 		});
 
 	// 返回按钮 
@@ -465,12 +500,10 @@ void MainWindow::show_question(int index)
 
 
 	// 显示错误次数和来源文件 (分成两个label)
-	QString sourceFile = to_QString(q.source_file);
-	sourceFile = QUrl::fromPercentEncoding(sourceFile.toUtf8());
-	// 只显示文件名，不显示路径
-	if(sourceFile.contains('/')) sourceFile = sourceFile.mid(sourceFile.lastIndexOf('/') + 1);
-	if(sourceFile.contains('\\')) sourceFile = sourceFile.mid(sourceFile.lastIndexOf('\\') + 1);
-	if(sourceFile.contains(':')) sourceFile = sourceFile.mid(sourceFile.lastIndexOf(':') + 1);
+	// 显示名在加载时已经算好 (只有文件名，不含路径)，完整路径放在提示里
+	const source_file & source = curr_bank_.file_of(q);
+	QString sourceFile = to_QString(source.display_name);
+	ui.lbl_QuizSource->setToolTip(QString::fromStdString(source.path));
 	
 	int errorCount = storage.get_mistake_count(q);
 	ui.lbl_QuizInfoRight->setText(QString("错误: %1").arg(errorCount));
@@ -502,25 +535,16 @@ void MainWindow::show_question(int index)
 	if(q.type == question_type::single || q.type == question_type::judge || q.type == question_type::multi)
 	{
 
-		for(const auto & optStr : q.options)
+		for(const option_view opt : q.options)
 		{
-			// 提取前缀 (A.) 和内容
-			QString fullText = to_QString(optStr);
-			QString prefix = ""; // "A"
-			QString content = fullText;
-
-			// 尝试分离 "A. Content"
-			int dotIdx = fullText.indexOf('.');
-			if(dotIdx > 0 && dotIdx <= 3)
-			{
-				prefix = fullText.left(dotIdx); // "A"
-				content = fullText.mid(dotIdx + 1).trimmed();
-			}
+			// 字母 (A) 和内容分开保存，无需再拆分 "A. Content"
+			QString prefix = QString(QChar(opt.letter));
+			QString content = to_QString(opt.text);
 
 			// 创建选项容器
 			QWidget * container = new QWidget();
 			container->setProperty("optionKey", prefix);
-			container->setProperty("fullText", fullText);
+			container->setProperty("optionBit", option_bit(opt.letter));
 			container->setProperty("isChecked", false);
 			container->setCursor(Qt::PointingHandCursor);
 			updateOptionStyle(container, false);
@@ -594,6 +618,7 @@ void MainWindow::show_question(int index)
 		
 		QString savedAns = user_answers_[index];
 		QString correctAns = to_QString(q.correct_answer);
+		uint32_t savedSelection = user_selections_[index];
 
 
 
@@ -657,9 +682,9 @@ void MainWindow::show_question(int index)
 
 				container->setEnabled(false); // 禁止修改
 
-				QString optKey = container->property("optionKey").toString();
-				bool isUserSelected = savedAns.contains(optKey);
-				bool isCorrectOption = correctAns.contains(optKey);
+				uint32_t optBit = container->property("optionBit").toUInt();
+				bool isUserSelected = (savedSelection & optBit) != 0;
+				bool isCorrectOption = (q.answer_mask & optBit) != 0;
 
 				// 恢复选中状态
 				if(isUserSelected) container->setProperty("isChecked", true);
@@ -961,13 +986,13 @@ void MainWindow::handleSubmitAnswer()
 	if(curr_questions_.empty()) return;
 
 	const question & q = curr_questions_[curr_index_];
+	const bool isChoice = q.type == question_type::single || q.type == question_type::judge || q.type == question_type::multi;
 	QString userAnswer = "";
+	uint32_t selection = 0; // 选择题: 选中选项的位掩码
 
 	// 1. 根据题型去布局里找控件
-	if(q.type == question_type::single || q.type == question_type::judge || q.type == question_type::multi)
+	if(isChoice)
 	{
-		QStringList selectedList;
-
 		// 遍历 layout_Options 的所有选项容器
 		for(int i = 0; i < ui.layout_Options->count(); ++i)
 		{
@@ -975,23 +1000,11 @@ void MainWindow::handleSubmitAnswer()
 			QWidget * container = item->widget();
 			if(container && container->property("isChecked").toBool())
 			{
-				QString optKey = container->property("optionKey").toString();
-				if(!optKey.isEmpty())
-				{
-					selectedList.append(optKey);
-				}
+				selection |= container->property("optionBit").toUInt();
+				// 单选和判断只取第一个选中的选项
+				if(q.type != question_type::multi && selection != 0) break;
 			}
 		}
-
-		if(q.type == question_type::multi)
-		{
-			selectedList.sort();
-			userAnswer = selectedList.join("");
-		}
-		else if(!selectedList.isEmpty())
-		{
-			userAnswer = selectedList.first();
-		}
 	}
 	else if(q.type == question_type::fill)
 	{
@@ -1015,11 +1028,21 @@ void MainWindow::handleSubmitAnswer()
 	if(curr_results_.size() > static_cast<size_t>(curr_index_))
 	{
 		user_answers_[curr_index_] = userAnswer;
+		user_selections_[curr_index_] = selection;
 	}
 
 	// 2. 判分逻辑
-	QString correctAns = to_QString(q.correct_answer).trimmed().toUpper();
-	bool isCorrect = (userAnswer.trimmed().toUpper() == correctAns);
+	// 选择题比较位掩码 (与选中顺序无关)；答案无法识别为选项字母时，只有答案为空且未选择才算对
+	bool isCorrect;
+	if(isChoice)
+	{
+		isCorrect = selection == q.answer_mask && (selection != 0 || q.correct_answer.empty());
+	}
+	else
+	{
+		QString correctAns = to_QString(q.correct_answer).trimmed().toUpper();
+		isCorrect = (userAnswer.trimmed().toUpper() == correctAns);
+	}
 
 	if(isCorrect)
 	{
@@ -1041,9 +1064,8 @@ void MainWindow::handleSubmitAnswer()
 	}
 
 	// 高亮选项：正确变绿，错误变红
-	if(q.type == question_type::single || q.type == question_type::judge || q.type == question_type::multi)
+	if(isChoice)
 	{
-		QString correctAnsUpper = to_QString(q.correct_answer).trimmed().toUpper();
 		for(int i = 0; i < ui.layout_Options->count(); ++i)
 		{
 			QLayoutItem * item = ui.layout_Options->itemAt(i);
@@ -1052,9 +1074,8 @@ void MainWindow::handleSubmitAnswer()
 
 			container->setEnabled(false); // 禁止再次点击
 
-			QString optKey = container->property("optionKey").toString();
 			bool isUserSelected = container->property("isChecked").toBool();
-			bool isCorrectOption = correctAnsUpper.contains(optKey);
+			bool isCorrectOption = (q.answer_mask & container->property("optionBit").toUInt()) != 0;
 
 			if(isCorrectOption)
 			{
@@ -1110,7 +1131,7 @@ void MainWindow::handleSubmitAnswer()
 				// 显示正确答案
 				QLabel* lblCorrectAns = new QLabel();
 				lblCorrectAns->setObjectName("lbl_CorrectAnswer");
-				lblCorrectAns->setText(QString("%1").arg(correctAns));
+				lblCorrectAns->setText(QString("%1").arg(to_QString(q.correct_answer).trimmed().toUpper()));
 				lblCorrectAns->setStyleSheet(QString(
 					"font-size: %1px; color: #2e7d32; font-weight: bold; padding: 12px; background-color: #c8e6c9; border: 2px solid #4caf50; border-radius: 6px;"
 				).arg(cfg.button_size));
@@ -1170,10 +1191,13 @@ void MainWindow::handleExitQuiz()
 // 考试历史记录
 void MainWindow::handleOpenHistory()
 {
+	// 只读最新的一页，更早的记录点 "加载更多" 再读
 	auto repo = homePage_->comboRepo()->currentText().toStdString();
-	auto records = storage.get_history(repo);
+	auto records = storage.get_history(repo, 0, history_page_size);
+	history_loaded_ = records.size();
 	
 	historyPage_->loadHistory(records);
+	historyPage_->setHasMore(history_loaded_ < storage.get_history_count(repo));
 	
 	ui.stackedWidget->setCurrentWidget(ui.page_History);
 }
@@ -1181,22 +1205,28 @@ void MainWindow::handleOpenHistory()
 // 考试配置
 void MainWindow::handleOpenExamConfig()
 {
-    // 刷题库
-    if(!init_start()) return;
-
-    int c_single=0, c_multi=0, c_judge=0, c_fill=0;
-    for(const auto & q : curr_questions_)
-    {
-        if(q.type == question_type::single) c_single++;
-        else if(q.type == question_type::multi) c_multi++;
-        else if(q.type == question_type::judge) c_judge++;
-        else if(q.type == question_type::fill) c_fill++;
-    }
-
-    std::vector<int> counts = { c_single, c_multi, c_judge, c_fill };
-    
-    examConfigPage_->refreshConfigList();
-    examConfigPage_->updateAvailableCounts(counts);
-
-    ui.stackedWidget->setCurrentWidget(ui.page_ExamConfig);
+    if(!check_selection()) return;
+
+    // 只读扫描并按首页设置筛选，统计各题型可用数量；题目在开始考试时才生成
+    view_selected_async([this](question_view_list views, bank_index index)
+        {
+            std::vector<size_t> selected = select_questions(index);
+            if(!check_selected(views.empty(), selected.empty())) return;
+
+            // 各题型数量只扫描索引的题型列
+            bank_index::summary summary = index.summarize(selected);
+            std::vector<int> counts;
+            for(auto type : { question_type::single, question_type::multi, question_type::judge, question_type::fill })
+            {
+                counts.push_back(static_cast<int>(summary.count(type)));
+            }
+
+            exam_views_ = std::move(views);
+            exam_selection_ = std::move(selected);
+            
+            examConfigPage_->refreshConfigList();
+            examConfigPage_->updateAvailableCounts(counts);
+
+            ui.stackedWidget->setCurrentWidget(ui.page_ExamConfig);
+        });
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <QtWidgets/QMainWindow>
 #include <print>
+#include <thread>
 #include <QLabel>
 #include <QAbstractButton>
 #include <QListWidget>
@@ -12,6 +13,9 @@
 #include "parser/text_parser.h"
 #include "platform_utils.h"
 #include "storage_manager.h"
+#include "bank_loader.h"
+#include "bank_load_task.h"
+#include "selection_plan.h"
 #include <QFile>
 #include <QTextStream>
 #include <QStringConverter>
@@ -24,11 +28,10 @@
 #include "pages/PracticeStrategyPage.h"
 
 #include <chrono>
-#include <unordered_set>
 
-inline QString to_QString(std::string currentQ)
+inline QString to_QString(std::string_view currentQ)
 {
-    return QString::fromUtf8(currentQ.c_str());
+    return QString::fromUtf8(currentQ.data(), static_cast<qsizetype>(currentQ.size()));
 }
 
 class HistoryPage;
@@ -41,7 +44,11 @@ class MainWindow : public QMainWindow
 
 public:
     MainWindow(QWidget *parent = nullptr);
-    ~MainWindow() {}
+    ~MainWindow()
+    {
+        // 后台加载引用了 parse_cache_，必须在成员析构之前停止 (子对象要到 QObject 析构时才删除)
+        delete load_task_;
+    }
 
 protected:
 
@@ -241,10 +248,17 @@ private:
     void finish_exam(); // 结算考试/练习
 
     storage_manager storage;
+    parse_cache parse_cache_;                // 题库解析缓存 (位于数据目录下)
+    std::jthread cache_cleanup_;             // 后台清理过期的解析缓存 (在 parse_cache_ 之后声明: 先停止并 join)
+    bank_load_task * load_task_ = nullptr;   // 正在进行的后台加载 (没有则为空)
 
+    question_bank curr_bank_;                // 当前题库 (题目字符串所在的内存区，必须比 curr_questions_ 后销毁)
+    question_view_list exam_views_;          // 考试配置页使用的只读视图 (开始考试时才生成题目)
+    std::vector<size_t> exam_selection_;     // exam_views_ 中按首页设置选中的题目
     std::vector<question> curr_questions_;   // 当前所有题目
     std::vector<answer_state> curr_results_; // 当前所有题目的回答状态
-    std::vector<QString> user_answers_;      // 当前所有题目的用户答案 (为了回显)
+    std::vector<QString> user_answers_;      // 当前所有题目的用户答案 (填空题，为了回显)
+    std::vector<uint32_t> user_selections_;  // 当前所有题目用户选中的选项 (选择题，位掩码)
     int curr_index_{};                       // 当前第几题
     bool is_exam_mode_{ false };             // 是否处于考试模式
     bool is_view_mode_{ false };             // 是否处于看题模式
@@ -254,6 +268,8 @@ private:
     HomePage * homePage_ = nullptr;          // 主页 Widget
     SettingsPage * settingsPage_ = nullptr;  // 设置页 Widget
     HistoryPage * historyPage_ = nullptr;    // 历史页 Widget
+    size_t history_loaded_ = 0;              // 历史页已显示的记录数
+    static constexpr size_t history_page_size = 50;
     ExamConfigPage * examConfigPage_ = nullptr; // 考试配置页 Widget
     ParserStrategyPage * parserStrategyPage_ = nullptr; // 解析策略页 Widget
     PracticeStrategyPage * practiceStrategyPage_ = nullptr; // 刷题策略页 Widget
@@ -267,180 +283,181 @@ private:
 
     // 考试配置辅助函数
 
-
-    bool init_start()
+    // 主页列表中选中的文件路径 (保持列表中的自然排序)
+    std::vector<std::string> selected_paths() const
     {
-        auto selected_items = homePage_->listWidgetFiles()->selectedItems();
-
-        if(selected_items.empty())
+        // 按行遍历而不是 selectedItems()，后者按点击顺序返回
+        std::vector<std::string> paths;
+        auto * listWidget = homePage_->listWidgetFiles();
+        for(int i = 0; i < listWidget->count(); ++i)
         {
-            QMessageBox::warning(this, "提示", "请先点击列表选中至少一个文件！");
-            return false;
-        }
-
-        std::vector<std::string> checked_paths;
-        checked_paths.reserve(selected_items.size());
-
-        // 提取路径
-        for(auto * item : selected_items)
-        {
-            checked_paths.push_back(item->data(Qt::UserRole).toString().toStdString());
+            auto * item = listWidget->item(i);
+            if(item->isSelected())
+            {
+                paths.push_back(item->data(Qt::UserRole).toString().toStdString());
+            }
         }
+        return paths;
+    }
 
-        // 根据用户选择的策略创建解析器
+    // 根据用户选择的策略创建解析器
+    text_parser current_parser() const
+    {
         QString strategyName = homePage_->comboParser()->currentData().toString();
-        text_parser parser;
-        if (!strategyName.isEmpty())
+        if(!strategyName.isEmpty())
         {
-            auto strategy = storage.get_parser_strategy(strategyName.toStdString());
-            if (strategy)
+            if(auto strategy = storage.get_parser_strategy(strategyName.toStdString()))
             {
-                parser = text_parser(*strategy);
+                return text_parser(*strategy);
             }
         }
+        return text_parser{};
+    }
 
-        std::vector<question> loaded_questions;
-        for (const auto& path : checked_paths)
-        {
-            QFile file(QString::fromStdString(path));
-            if (file.open(QIODevice::ReadOnly | QIODevice::Text))
+    // 在后台处理选中的文件，完成后在 GUI 线程用加载任务调用 on_finished (此时可取走结果)；取消时不调用
+    void start_load_task(bank_load_task::mode load_mode, std::function<void(bank_load_task &)> on_finished)
+    {
+        if(load_task_) return; // 已有加载在进行
+
+        // 完整解析时按刷题策略在加载过程中去重
+        bool dedup = load_mode == bank_load_task::mode::questions && practiceStrategyPage_->excludeDuplicates();
+        load_task_ = new bank_load_task(selected_paths(), current_parser(), &parse_cache_, load_mode, dedup, this);
+        homePage_->setLoading(true);
+
+        auto end_loading = [this]()
             {
-                QTextStream in(&file);
-                in.setEncoding(QStringConverter::Utf8);
-                // 先全部读入字符串
-                QString content = in.readAll();
-                std::string std_content = content.toStdString();
-                
-                // 手动提取文件名以避免 std::filesystem 系统错误
-                std::string filename = path;
-                size_t last_slash = filename.find_last_of("/\\");
-                if (last_slash != std::string::npos) {
-                    filename = filename.substr(last_slash + 1);
-                }
-                
-                auto qs = parser.parse(std_content, filename);
-                loaded_questions.insert(loaded_questions.end(), std::make_move_iterator(qs.begin()), std::make_move_iterator(qs.end()));
-                file.close();
-            }
-            else
+                homePage_->setLoading(false);
+                load_task_->deleteLater();
+                load_task_ = nullptr;
+            };
+
+        connect(load_task_, &bank_load_task::progress_changed, homePage_, &HomePage::setLoadProgress);
+        connect(load_task_, &bank_load_task::cancelled, this, end_loading);
+        connect(load_task_, &bank_load_task::finished, this, [this, end_loading, on_finished = std::move(on_finished)]()
             {
-               qCritical() << "Failed to open file:" << QString::fromStdString(path);
-            }
-        }
-        
-        // 去重 (根据设置决定是否去重)
-        std::vector<question> questions;
-        questions.reserve(loaded_questions.size());
-        
-        if (practiceStrategyPage_->excludeDuplicates())
-        {
-            std::unordered_set<size_t> seen_ids;
-            for(const auto & q : loaded_questions)
+                bank_load_task * task = load_task_;
+                end_loading(); // deleteLater: 回调返回前 task 仍然有效
+                on_finished(*task);
+            });
+
+        load_task_->start();
+    }
+
+    // 取出后台建立的列式索引，并填写错题次数列
+    bank_index take_index(bank_load_task & task) const
+    {
+        bank_index index = task.take_index();
+        index.update_mistakes([this](size_t id) { return storage.get_mistake_count(id); });
+        return index;
+    }
+
+    // 在后台读取并解析选中的文件，完成后在 GUI 线程调用 on_loaded；取消时不调用
+    void load_selected_async(std::function<void(question_bank, bank_index)> on_loaded)
+    {
+        start_load_task(bank_load_task::mode::questions, [this, on_loaded = std::move(on_loaded)](bank_load_task & task)
             {
-                size_t id = q.get_id();
-                if(seen_ids.find(id) == seen_ids.end())
-                {
-                    questions.push_back(q);
-                    seen_ids.insert(id);
-                }
-            }
-        }
-        else
-        {
-            questions = std::move(loaded_questions);
-        }
+                on_loaded(task.take_bank(), take_index(task));
+            });
+    }
 
-        if(questions.empty())
+    // 在后台只读扫描选中的文件 (不生成字符串)，完成后在 GUI 线程调用 on_scanned；取消时不调用
+    void view_selected_async(std::function<void(question_view_list, bank_index)> on_scanned)
+    {
+        start_load_task(bank_load_task::mode::views, [this, on_scanned = std::move(on_scanned)](bank_load_task & task)
+            {
+                on_scanned(task.take_views(), take_index(task));
+            });
+    }
+
+    // 检查是否选中了文件
+    bool check_selection()
+    {
+        if(homePage_->listWidgetFiles()->selectedItems().empty())
         {
-            QMessageBox::warning(this, "提示", "文件里无题目！");
+            QMessageBox::warning(this, "提示", "请先点击列表选中至少一个文件！");
             return false;
         }
+        return true;
+    }
 
-        curr_questions_.clear();
-        curr_index_ = 0;
-        user_answers_.clear();
-
-        auto option{ homePage_->mistakeOp() };
-        auto cnt{ static_cast<size_t>(homePage_->mistakeCount()) };
+    // 加载选中的文件并按首页设置筛选，成功后调用 on_ready 开始答题
+    void init_start(std::function<void()> on_ready)
+    {
+        if(!check_selection()) return;
 
-        auto predicate = [=, this](const question & q)
+        // 后台并行读取并解析所有选中文件
+        load_selected_async([this, on_ready = std::move(on_ready)](question_bank loaded, bank_index index)
             {
-                if(option == 1) return storage.get_mistake_count(q) >= static_cast<int>(cnt);
-                if(option == 2) return storage.get_mistake_count(q) == static_cast<int>(cnt);
-                return true;
-            };
+                if(prepare_questions(std::move(loaded), index)) on_ready();
+            });
+    }
 
-        for(auto & q : questions)
-        {
-            bool should_add = false;
+    // 当前界面上的筛选条件: 首页的题型和错题设置 + 刷题策略页
+    selection_filters current_filters() const
+    {
+        selection_filters filters;
+        filters.types = { homePage_->isSingleChecked(), homePage_->isMultiChecked(), homePage_->isJudgeChecked(), homePage_->isFillChecked() };
+        filters.mistake_op = homePage_->mistakeOp();
+        filters.mistake_count = static_cast<uint32_t>(std::max(0, homePage_->mistakeCount()));
+        filters.strategy = practiceStrategyPage_->getStrategy();
+        filters.most_common_single = practiceStrategyPage_->mostCommonSingleMask();
+        filters.most_common_judge = practiceStrategyPage_->mostCommonJudgeMask();
+        return filters;
+    }
 
-            switch(q.type)
-            {
-                case question_type::single:
-                    if(homePage_->isSingleChecked())
-                    {
-                        should_add = true;
-                        // 使用优先级跳过逻辑
-                        if (practiceStrategyPage_->shouldSkipSingle(QString::fromStdString(q.correct_answer)))
-                        {
-                            should_add = false;
-                        }
-                    }
-                    break;
-                case question_type::multi:
-                    if(homePage_->isMultiChecked())
-                    {
-                        // 如果启用了排除多选全选题，检查答案是否包含所有选项
-                        if (practiceStrategyPage_->excludeMultiAll() && !q.options.empty())
-                        {
-                            // 检查答案长度是否等于选项数量
-                            if (q.correct_answer.length() >= q.options.size())
-                            {
-                                should_add = false; // 排除全选题
-                            }
-                            else
-                            {
-                                should_add = true;
-                            }
-                        }
-                        else
-                        {
-                            should_add = true;
-                        }
-                    }
-                    break;
-                case question_type::judge:
-                    if(homePage_->isJudgeChecked())
-                    {
-                        should_add = true;
-                        // 使用优先级跳过逻辑
-                        if (practiceStrategyPage_->shouldSkipJudge(QString::fromStdString(q.correct_answer)))
-                        {
-                            should_add = false;
-                        }
-                    }
-                    break;
-                case question_type::fill:
-                    if(homePage_->isFillChecked())   should_add = true;
-                    break;
-                default:
-                    break;
-            }
+    // 按去重设置、首页的题型和错题筛选、刷题策略选出题目，返回行号 (保持原顺序)
+    // already_deduplicated: 题目在加载时已经去重，跳过去重这一步
+    std::vector<size_t> select_questions(const bank_index & index, bool already_deduplicated = false) const
+    {
+        selection_filters filters = current_filters();
+        if(already_deduplicated) filters.strategy.exclude_duplicates = false;
+        return selection_plan(filters).select(index);
+    }
 
-            if(should_add && predicate(q))
-                curr_questions_.emplace_back(std::move(q));
+    // 以 bank 中的全部题目开始新一轮答题: 题目仍在 bank 的内存区中，由 curr_bank_ 接管
+    void begin_session(question_bank bank)
+    {
+        // 先释放旧题目，再释放旧题库的内存区
+        curr_questions_ = std::move(bank.questions());
+        curr_bank_ = std::move(bank);
+        curr_index_ = 0;
 
-        }
+        // 初始化用户答案记录
+        user_answers_.clear();
+        user_answers_.resize(curr_questions_.size());
+        user_selections_.assign(curr_questions_.size(), 0);
+    }
 
-        if(curr_questions_.empty())
+    // 检查筛选结果，有题目时返回 true
+    bool check_selected(bool loaded_empty, bool selected_empty)
+    {
+        if(loaded_empty)
+        {
+            QMessageBox::warning(this, "提示", "文件里无题目！");
+            return false;
+        }
+        if(selected_empty)
         {
             QMessageBox::warning(this, "提示", "筛选后无题目！");
             return false;
         }
+        return true;
+    }
 
-        // 初始化用户答案记录
-        user_answers_.resize(curr_questions_.size());
+    // 去重和筛选，结果放入 curr_questions_
+    bool prepare_questions(question_bank loaded, const bank_index & index)
+    {
+        std::vector<size_t> selected = select_questions(index, loaded.deduplicated());
+        if(!check_selected(loaded.empty(), selected.empty())) return false;
+
+        // 选中的题目移动构造到新数组 (直接接管字符串，不复制；移动赋值在内存区不同时会复制)
+        std::vector<question> & questions = loaded.questions();
+        std::vector<question> kept;
+        kept.reserve(selected.size());
+        for(size_t i : selected) kept.push_back(std::move(questions[i]));
+        questions = std::move(kept);
 
+        begin_session(std::move(loaded));
         return true;
     }
 
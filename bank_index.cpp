@@ -0,0 +1,47 @@
+﻿#include "bank_index.h"
+
+#include <algorithm>
+
+void bank_index::reserve(size_t count)
+{
+    types_.reserve(count);
+    answer_masks_.reserve(count);
+    option_counts_.reserve(count);
+    file_ids_.reserve(count);
+    ids_.reserve(count);
+    mistake_counts_.reserve(count);
+}
+
+void bank_index::update_mistakes(const std::function<int(size_t id)> & mistake_count)
+{
+    for(size_t row = 0; row < ids_.size(); ++row)
+    {
+        mistake_counts_[row] = static_cast<uint32_t>(std::max(0, mistake_count(ids_[row])));
+    }
+}
+
+// 只读取题型和答案两列
+void bank_index::add_to(summary & result, size_t row) const
+{
+    uint8_t type = types_[row];
+    uint32_t mask = answer_masks_[row];
+    result.type_counts[std::min<size_t>(type, result.type_counts.size() - 1)]++;
+
+    if(!std::has_single_bit(mask)) return;
+    if(type == static_cast<uint8_t>(question_type::single)) result.single_answers[std::countr_zero(mask)]++;
+    else if(type == static_cast<uint8_t>(question_type::judge)) result.judge_answers[std::countr_zero(mask)]++;
+}
+
+bank_index::summary bank_index::summarize() const
+{
+    summary result;
+    for(size_t row = 0; row < size(); ++row) add_to(result, row);
+    return result;
+}
+
+bank_index::summary bank_index::summarize(std::span<const size_t> rows) const
+{
+    summary result;
+    for(size_t row : rows) add_to(result, row);
+    return result;
+}
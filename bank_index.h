@@ -0,0 +1,76 @@
+﻿#pragma once
+
+#include "question.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+// 题库的列式索引: 只保存筛选和统计用到的字段，每个字段一列连续存放
+// 题型筛选、错题筛选和答案分布统计只扫描这几列，不再逐个访问完整的题目对象
+// 行号与建立索引时的题目下标一一对应
+class bank_index
+{
+public:
+    // 一次扫描得到的统计结果
+    struct summary
+    {
+        std::array<size_t, 5> type_counts{};     // 各题型数量，下标为 question_type
+        std::array<size_t, 32> single_answers{}; // 单选题答案分布，下标为答案字母 (A=0)，只统计单个字母的答案
+        std::array<size_t, 32> judge_answers{};  // 判断题答案分布 (A=对，B=错)
+
+        size_t count(question_type type) const { return type_counts[static_cast<size_t>(type)]; }
+    };
+
+    // 由题目或题目视图建立 (Q 为 question 或 question_view，两者字段同名)
+    // 错题次数列初始为 0，由 update_mistakes 填写
+    template<typename Q>
+    static bank_index build(std::span<const Q> questions)
+    {
+        bank_index index;
+        index.reserve(questions.size());
+        for(const Q & q : questions)
+        {
+            index.types_.push_back(static_cast<uint8_t>(q.type));
+            index.answer_masks_.push_back(q.answer_mask);
+            index.option_counts_.push_back(static_cast<uint16_t>(std::min<size_t>(q.options.size(), UINT16_MAX)));
+            index.file_ids_.push_back(q.file_id);
+            index.ids_.push_back(q.get_id());
+        }
+        index.mistake_counts_.assign(questions.size(), 0);
+        return index;
+    }
+
+    // 按 ID 列重新查询每行的错题次数
+    void update_mistakes(const std::function<int(size_t id)> & mistake_count);
+
+    size_t size() const { return ids_.size(); }
+    bool empty() const { return ids_.empty(); }
+
+    question_type type(size_t row) const { return static_cast<question_type>(types_[row]); }
+
+    std::span<const uint8_t> types() const { return types_; }
+    std::span<const uint32_t> answer_masks() const { return answer_masks_; }
+    std::span<const uint16_t> option_counts() const { return option_counts_; }
+    std::span<const uint32_t> file_ids() const { return file_ids_; }
+    std::span<const size_t> ids() const { return ids_; }
+    std::span<const uint32_t> mistake_counts() const { return mistake_counts_; }
+
+    // 统计全部行 / 指定的行
+    summary summarize() const;
+    summary summarize(std::span<const size_t> rows) const;
+
+private:
+    void reserve(size_t count);
+    void add_to(summary & result, size_t row) const;
+
+    std::vector<uint8_t> types_;
+    std::vector<uint32_t> answer_masks_;
+    std::vector<uint16_t> option_counts_;
+    std::vector<uint32_t> file_ids_;
+    std::vector<size_t> ids_;
+    std::vector<uint32_t> mistake_counts_;
+};
@@ -0,0 +1,112 @@
+﻿#include "bank_load_task.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+#include <QDebug>
+#include <QFileInfo>
+
+bank_load_task::bank_load_task(std::vector<std::string> paths, text_parser parser, const parse_cache * cache, mode load_mode, bool dedup,
+                               QObject * parent)
+    : QObject(parent), paths_(std::move(paths)), parser_(std::move(parser)), cache_(cache), mode_(load_mode), dedup_(dedup)
+{
+}
+
+bank_load_task::~bank_load_task()
+{
+    cancel();
+    if(worker_.joinable()) worker_.join();
+}
+
+void bank_load_task::start()
+{
+    worker_ = std::jthread([this](std::stop_token stop) { run(stop); });
+}
+
+void bank_load_task::cancel()
+{
+    worker_.request_stop();
+}
+
+void bank_load_task::run(std::stop_token stop)
+{
+    // 先统计文件大小，用于按字节计算进度
+    std::vector<qint64> sizes;
+    sizes.reserve(paths_.size());
+    qint64 bytes_total = 0;
+    for(const auto & path : paths_)
+    {
+        sizes.push_back(QFileInfo(QString::fromStdString(path)).size());
+        bytes_total += sizes.back();
+    }
+
+    const int files_total = static_cast<int>(paths_.size());
+    emit progress_changed(0, files_total, 0, bytes_total);
+
+    // 每完成一个文件报告一次 (来自任意工作线程，信号自动排队到 GUI 线程)
+    std::atomic<int> files_done{ 0 };
+    std::atomic<qint64> bytes_done{ 0 };
+    auto on_file_done = [&](size_t index)
+        {
+            int files = ++files_done;
+            qint64 bytes = bytes_done += sizes[index];
+            emit progress_changed(files, files_total, bytes, bytes_total);
+        };
+
+    auto start_time = std::chrono::steady_clock::now();
+    auto elapsed_ms = [&]()
+        {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
+        };
+
+    // 结果交给 GUI 线程: 排队调用保证 bank_ / views_ 只在 GUI 线程读写
+    auto deliver = [this, &stop](auto result, auto store)
+        {
+            if(stop.stop_requested())
+            {
+                QMetaObject::invokeMethod(this, [this]() { emit cancelled(); }, Qt::QueuedConnection);
+                return;
+            }
+            QMetaObject::invokeMethod(this, [this, result, store]()
+                {
+                    store(std::move(*result));
+                    emit finished();
+                }, Qt::QueuedConnection);
+        };
+
+    if(mode_ == mode::views)
+    {
+        auto views = std::make_shared<question_view_list>(bank_loader::view_files(paths_, parser_, stop, on_file_done));
+        auto index = std::make_shared<bank_index>(bank_index::build(std::span<const question_view>(views->views())));
+        qInfo() << "Scanned" << views->size() << "questions from" << files_total << "files in" << elapsed_ms() << "ms";
+        deliver(views, [this, index](question_view_list && result)
+            {
+                views_ = std::move(result);
+                index_ = std::move(*index);
+            });
+        return;
+    }
+
+    auto bank = std::make_shared<question_bank>(bank_loader::load_files(paths_, parser_, cache_, dedup_, stop, on_file_done));
+    auto index = std::make_shared<bank_index>(bank_index::build(std::span<const question>(bank->questions())));
+    qInfo() << "Loaded" << bank->size() << "questions from" << files_total << "files in" << elapsed_ms() << "ms,"
+            << "arena" << bank->arena_bytes() / 1024 << "KiB";
+    if(dedup_)
+    {
+        // 去重统计: 每个文件丢弃了多少道重复题目
+        size_t dropped = 0;
+        for(const auto & file : bank->files())
+        {
+            if(file.duplicates == 0) continue;
+            dropped += file.duplicates;
+            qInfo() << "  duplicates dropped from" << QString::fromStdString(file.display_name) << ":" << file.duplicates;
+        }
+        qInfo() << "Dropped" << dropped << "duplicate questions";
+    }
+    deliver(bank, [this, index](question_bank && result)
+        {
+            bank_ = std::move(result);
+            index_ = std::move(*index);
+        });
+}
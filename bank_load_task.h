@@ -0,0 +1,60 @@
+﻿#pragma once
+
+#include "question.h"
+#include "question_bank.h"
+#include "question_view.h"
+#include "bank_index.h"
+#include "bank_loader.h"
+#include "parser/text_parser.h"
+#include <string>
+#include <vector>
+#include <thread>
+
+#include <QObject>
+
+// 后台加载题库: 在工作线程中读取并解析文件，GUI 线程不被阻塞
+// 进度和结果通过排队信号回到 GUI 线程；可随时取消 (已开始解析的文件会解析完，不再领取新文件)
+class bank_load_task : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class mode
+    {
+        questions,  // 完整解析为题目 (开始答题)
+        views,      // 只读扫描为视图 (统计)，不查解析缓存
+    };
+
+    // dedup: 完整解析时在加载过程中跨文件去重 (只读扫描不去重，由筛选处理)
+    bank_load_task(std::vector<std::string> paths, text_parser parser, const parse_cache * cache, mode load_mode, bool dedup,
+                   QObject * parent = nullptr);
+    ~bank_load_task() override; // 请求停止并等待工作线程结束
+
+    void start();
+    void cancel();
+
+    // finished 之后取走结果 (只能在 GUI 线程调用)
+    // 列式索引在工作线程中随结果一起建立，行号与题目 / 视图的下标一致 (错题次数列未填写)
+    question_bank take_bank() { return std::move(bank_); }
+    question_view_list take_views() { return std::move(views_); }
+    bank_index take_index() { return std::move(index_); }
+
+signals:
+    void progress_changed(int files_done, int files_total, qint64 bytes_done, qint64 bytes_total);
+    void finished();
+    void cancelled();
+
+private:
+    void run(std::stop_token stop);
+
+    std::vector<std::string> paths_;
+    text_parser parser_;
+    const parse_cache * cache_;
+    mode mode_;
+    bool dedup_;
+    question_bank bank_;
+    question_view_list views_;
+    bank_index index_;
+
+    std::jthread worker_; // 最后声明: 析构时最先 join，保证工作线程不会访问已销毁的成员
+};
@@ -0,0 +1,350 @@
+﻿#include "bank_loader.h"
+#include "encoding_utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+#include <QFile>
+#include <QFileInfo>
+#include <QUrl>
+#include <QDebug>
+
+namespace
+{
+    // 由工作线程池处理 count 个文件: 每个线程从共享计数器领取下一个下标，直到全部领完或 stop 被请求
+    // process 的第二个参数为该文件内部可用的解析线程数: CPU 核心由仍在工作的文件线程均分，
+    // 避免每个大文件各自再开满核心数的线程；文件线程陆续退出后，剩下的大文件分到更多线程
+    void for_each_file(size_t count, std::stop_token stop, const bank_loader::file_done_callback & on_file_done,
+                       const std::function<void(size_t index, size_t thread_budget)> & process)
+    {
+        // 工作线程数: 不超过文件数和 CPU 核心数
+        const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+        size_t worker_count = std::min<size_t>(count, cores);
+
+        std::atomic<size_t> next_index{ 0 };
+        std::atomic<size_t> active{ worker_count };
+        auto worker = [&]()
+            {
+                for(size_t i = next_index++; i < count && !stop.stop_requested(); i = next_index++)
+                {
+                    process(i, std::max<size_t>(1, cores / active.load()));
+                    if(on_file_done) on_file_done(i);
+                }
+                --active;
+            };
+
+        // 返回时 jthread 析构，自动 join
+        std::vector<std::jthread> workers;
+        workers.reserve(worker_count);
+        for(size_t i = 0; i < worker_count; ++i)
+        {
+            workers.emplace_back(worker);
+        }
+    }
+}
+
+std::string bank_loader::file_name_of(const std::string & path)
+{
+    size_t last_slash = path.find_last_of("/\\");
+    if(last_slash == std::string::npos) return path;
+    return path.substr(last_slash + 1);
+}
+
+std::string bank_loader::display_name_of(const std::string & path)
+{
+    QString name = QUrl::fromPercentEncoding(QByteArray::fromStdString(file_name_of(path)));
+    qsizetype cut = 0;
+    for(QChar sep : { QChar('/'), QChar('\\'), QChar(':') })
+    {
+        cut = std::max(cut, name.lastIndexOf(sep) + 1);
+    }
+    return name.mid(cut).toStdString();
+}
+
+std::string_view bank_loader::strip_utf8_bom(std::string_view content)
+{
+    if(content.starts_with("\xEF\xBB\xBF")) content.remove_prefix(3);
+    return content;
+}
+
+std::optional<std::vector<question>> bank_loader::load_file(const std::string & path, const text_parser & parser, const parse_cache * cache,
+                                                           const arena_source & arenas, uint32_t file_id, size_t max_workers)
+{
+    // 以二进制方式打开: 文本模式的 \r\n 转换由 text_parser 在生成题目时处理
+    QFile file(QString::fromStdString(path));
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        return std::nullopt;
+    }
+
+    const qint64 size = file.size();
+    if(size <= 0) return std::vector<question>{};
+
+    if(static_cast<size_t>(size) > streaming_threshold)
+    {
+        file.close();
+        std::vector<question> questions;
+        if(!load_file_streaming(path, parser, [&](question && q) { questions.push_back(std::move(q)); },
+                                arenas ? arenas(static_cast<size_t>(size)) : std::pmr::get_default_resource(), file_id))
+        {
+            return std::nullopt;
+        }
+        return questions;
+    }
+
+    // 优先内存映射: 解析器直接读取映射的字节，不经过 QString 中转
+    // 映射失败 (部分文件系统不支持) 时退回到一次性读取
+    QByteArray fallback;
+    std::string_view content;
+    if(uchar * mapped = file.map(0, size))
+    {
+        content = std::string_view(reinterpret_cast<const char *>(mapped), static_cast<size_t>(size));
+    }
+    else
+    {
+        fallback = file.readAll();
+        content = std::string_view(fallback.constData(), static_cast<size_t>(fallback.size()));
+    }
+
+    // 缓存键: 大小和修改时间之外再核对内容哈希，防止修改时间未变但内容已变
+    parse_cache::file_key key;
+    if(cache)
+    {
+        key = { size, QFileInfo(file).lastModified().toMSecsSinceEpoch(), stable_hash(content), parser.strategy().hash() };
+        if(auto cached = cache->load(path, key, file_id, arenas ? arenas(static_cast<size_t>(size)) : std::pmr::get_default_resource()))
+        {
+            return cached;
+        }
+    }
+
+    // GBK / UTF-16 等编码先转码为 UTF-8；UTF-8 文件 (常见情况) 直接解析映射的字节
+    // 检测出的编码无法解码时按读取失败处理
+    std::optional<std::string> transcoded;
+    if(!encoding_utils::to_utf8(content, transcoded)) return std::nullopt;
+    if(transcoded) content = *transcoded;
+
+    auto questions = parser.parse(strip_utf8_bom(content), file_id, arenas, max_workers);
+
+    // 题目已复制出所需字段，此时可以解除映射
+    file.close();
+
+    if(cache) cache->store(path, key, questions);
+    return questions;
+}
+
+bool bank_loader::load_file_streaming(const std::string & path, const text_parser & parser, const text_parser::stream::sink_type & sink,
+                                      std::pmr::memory_resource * resource, uint32_t file_id)
+{
+    QFile file(QString::fromStdString(path));
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    text_parser::stream stream(parser, file_id, sink, resource);
+    // 缓冲区前部留出位置，放上一块末尾被截断的 UTF-8 多字节序列 (carry 个字节)，与本块一起校验
+    std::string chunk(stream_chunk_size + 4, '\0');
+    size_t carry = 0;
+    bool first = true;
+    bool validate = true;   // 仍按 UTF-8 逐块校验
+
+    // 非 UTF-8 文件: 用有状态的解码器逐块转码，跨块截断的多字节字符由解码器衔接
+    std::optional<encoding_utils::text_decoder> decoder;
+    std::string utf8;
+
+    while(true)
+    {
+        qint64 n = file.read(chunk.data() + carry, static_cast<qint64>(stream_chunk_size));
+        if(n <= 0) break;
+
+        std::string_view data(chunk.data(), carry + static_cast<size_t>(n));
+        carry = 0;
+
+        // 每块都校验: 开头合法不代表整个文件都是 UTF-8 (例如前面全是 ASCII 的 GBK 文件)
+        // 第一次遇到非法序列时按本块 (含上一块留下的字节) 检测编码，从本块起改用解码器；仍无法判断时按 UTF-8 原样解析
+        // 检测出的编码无法解码时整个文件算作失败，不按 UTF-8 误解析
+        if(validate && !encoding_utils::is_valid_utf8(data, true))
+        {
+            validate = false;
+            if(auto encoding = encoding_utils::detect(data, true); encoding != encoding_utils::text_encoding::utf8)
+            {
+                decoder.emplace(encoding);
+                if(!decoder->is_valid())
+                {
+                    qWarning() << "Unsupported text encoding:" << QString::fromStdString(path);
+                    return false;
+                }
+            }
+            else
+            {
+                qWarning() << "Invalid UTF-8 in unrecognized encoding, parsing as UTF-8:" << QString::fromStdString(path);
+            }
+        }
+        if(first)
+        {
+            first = false;
+            if(!decoder) data = strip_utf8_bom(data);
+        }
+
+        if(decoder)
+        {
+            utf8.clear();
+            decoder->decode(data, utf8);
+            stream.feed(utf8);
+        }
+        else if(validate)
+        {
+            carry = encoding_utils::truncated_utf8_tail(data);
+            stream.feed(data.substr(0, data.size() - carry));
+            std::memmove(chunk.data(), data.data() + data.size() - carry, carry);
+        }
+        else
+        {
+            stream.feed(data);
+        }
+    }
+
+    // 文件末尾残留的不完整序列照常交给解析器
+    if(carry > 0) stream.feed(std::string_view(chunk.data(), carry));
+    stream.finish();
+    return true;
+}
+
+question_bank bank_loader::load_files(const std::vector<std::string> & paths, const text_parser & parser, const parse_cache * cache,
+                                      bool dedup, std::stop_token stop, const file_done_callback & on_file_done)
+{
+    // 每个文件的结果放在自己的槽位里，工作线程之间互不干扰
+    // 题目字符串直接分配在题库的内存区里 (每个文件至少一个内存区)，合并时只移动题目对象
+    question_bank bank;
+    const arena_source arenas = bank.arenas();
+    std::vector<std::vector<question>> per_file(paths.size());
+
+    // 文件表在启动工作线程前建好，文件 i 的题目 file_id 即 i
+    bank.files().reserve(paths.size());
+    for(const auto & path : paths) bank.files().push_back({ path, display_name_of(path) });
+
+    // 去重: 每个文件解析完就在工作线程里登记 ID，已有更靠前出现的题目立即丢弃
+    // 保留的题目移动构造到新数组: 移动构造总是直接接管字符串，而移动赋值在内存区不同 (并行解析的分片) 时会复制
+    dedup_set seen;
+    auto drop_if = [](std::vector<question> & qs, auto is_duplicate)
+        {
+            std::vector<question> kept;
+            kept.reserve(qs.size());
+            for(auto & q : qs)
+            {
+                if(!is_duplicate(q)) kept.push_back(std::move(q));
+            }
+            size_t dropped = qs.size() - kept.size();
+            qs = std::move(kept);
+            return dropped;
+        };
+
+    for_each_file(paths.size(), stop, on_file_done, [&](size_t i, size_t thread_budget)
+        {
+            if(auto qs = load_file(paths[i], parser, cache, arenas, static_cast<uint32_t>(i), thread_budget))
+            {
+                per_file[i] = std::move(*qs);
+                if(dedup)
+                {
+                    bank.files()[i].duplicates = drop_if(per_file[i], [&](const question & q)
+                        {
+                            return !seen.claim(q.get_id(), dedup_set::order_of(i, q.block_offset));
+                        });
+                }
+            }
+            else
+            {
+                qCritical() << "Failed to read file:" << QString::fromStdString(paths[i]);
+            }
+        });
+
+    // 并行登记时靠后的文件可能先完成，全部登记后再丢弃被更靠前的出现取代的题目
+    if(dedup)
+    {
+        for(size_t i = 0; i < per_file.size(); ++i)
+        {
+            bank.files()[i].duplicates += drop_if(per_file[i], [&](const question & q)
+                {
+                    return !seen.owns(q.get_id(), dedup_set::order_of(i, q.block_offset));
+                });
+        }
+    }
+
+    bank.set_deduplicated(dedup);
+
+    // 按原始顺序合并
+    size_t total = 0;
+    for(const auto & qs : per_file) total += qs.size();
+
+    std::vector<question> & result = bank.questions();
+    result.reserve(total);
+    for(auto & qs : per_file)
+    {
+        result.insert(result.end(), std::make_move_iterator(qs.begin()), std::make_move_iterator(qs.end()));
+    }
+
+    return bank;
+}
+
+bool bank_loader::view_file(const std::string & path, const text_parser & parser, question_view_list & out, size_t max_workers)
+{
+    auto file = std::make_shared<QFile>(QString::fromStdString(path));
+    if(!file->open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    const qint64 size = file->size();
+    if(size <= 0) return true;
+
+    // 视图直接指向映射的字节，映射随 out 一起保留；映射失败时保留一次性读取的内容
+    std::string_view content;
+    if(uchar * mapped = file->map(0, size))
+    {
+        content = std::string_view(reinterpret_cast<const char *>(mapped), static_cast<size_t>(size));
+        out.keep_alive(file);
+    }
+    else
+    {
+        auto data = std::make_shared<QByteArray>(file->readAll());
+        content = std::string_view(data->constData(), static_cast<size_t>(data->size()));
+        out.keep_alive(data);
+    }
+
+    std::optional<std::string> transcoded;
+    if(!encoding_utils::to_utf8(content, transcoded)) return false;
+    if(transcoded)
+    {
+        auto data = std::make_shared<std::string>(std::move(*transcoded));
+        content = *data;
+        out.keep_alive(data);
+    }
+
+    uint32_t file_id = out.add_file({ path, display_name_of(path) });
+    parser.parse_views(strip_utf8_bom(content), file_id, out, max_workers);
+    return true;
+}
+
+question_view_list bank_loader::view_files(const std::vector<std::string> & paths, const text_parser & parser,
+                                           std::stop_token stop, const file_done_callback & on_file_done)
+{
+    std::vector<question_view_list> per_file(paths.size());
+
+    for_each_file(paths.size(), stop, on_file_done, [&](size_t i, size_t thread_budget)
+        {
+            if(!view_file(paths[i], parser, per_file[i], thread_budget))
+            {
+                qCritical() << "Failed to read file:" << QString::fromStdString(paths[i]);
+            }
+        });
+
+    question_view_list result;
+    for(auto & views : per_file)
+    {
+        result.append(std::move(views));
+    }
+    return result;
+}
@@ -0,0 +1,61 @@
+﻿#pragma once
+
+#include "question.h"
+#include "parser/text_parser.h"
+#include "parse_cache.h"
+#include "question_bank.h"
+#include "question_view.h"
+#include "dedup_set.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <functional>
+#include <stop_token>
+
+// 题库加载: 读取 txt 文件并交给 text_parser 解析
+namespace bank_loader
+{
+    // 从完整路径中提取文件名 (手动处理，避免 std::filesystem 的系统编码问题)
+    std::string file_name_of(const std::string & path);
+
+    // 界面上显示的来源名: 文件名经 URL 解码后，再去掉残留的路径和盘符部分
+    std::string display_name_of(const std::string & path);
+
+    // 去掉 UTF-8 BOM (EF BB BF)
+    std::string_view strip_utf8_bom(std::string_view content);
+
+    // 超过该大小的文件改用流式解析，内存占用与文件大小无关
+    inline constexpr size_t streaming_threshold = 64 * 1024 * 1024;
+    inline constexpr size_t stream_chunk_size = 1024 * 1024;
+
+    // 分块读取并流式解析，每解析出一道题就交给 sink；文件无法打开或编码无法解码时返回 false
+    bool load_file_streaming(const std::string & path, const text_parser & parser, const text_parser::stream::sink_type & sink,
+                             std::pmr::memory_resource * resource = std::pmr::get_default_resource(), uint32_t file_id = 0);
+
+    // 读取并解析单个文件 (内存映射，零拷贝；大文件走流式解析)，文件无法打开或编码无法解码时返回 std::nullopt
+    // 传入 cache 时先查解析缓存，命中则跳过解析；未命中时解析后写入缓存
+    // 传入 arenas 时题目字符串分配在其提供的内存区中；file_id 写入每道题
+    // max_workers 为文件内部并行解析的线程上限 (见 text_parser::parse)，0 表示不超过 CPU 核心数
+    std::optional<std::vector<question>> load_file(const std::string & path, const text_parser & parser, const parse_cache * cache = nullptr,
+                                                   const arena_source & arenas = {}, uint32_t file_id = 0, size_t max_workers = 0);
+
+    // 只读扫描单个文件: 题目以视图形式追加到 out (文件登记到 out 的文件表)，文件保持映射直到 out 销毁；文件无法打开或编码无法解码时返回 false
+    // 不查解析缓存，也不生成字符串，适合统计题目数量和答案分布
+    bool view_file(const std::string & path, const text_parser & parser, question_view_list & out, size_t max_workers = 0);
+
+    // 每完成一个文件调用一次 (来自任意工作线程)，参数为该文件在 paths 中的下标
+    using file_done_callback = std::function<void(size_t index)>;
+
+    // 并行读取并解析多个文件
+    // 每个文件一个任务，由工作线程池处理 (大文件内部的并行线程与文件线程共享 CPU 核心)；结果按 paths 的顺序 (即 get_repo_file 的自然排序) 合并
+    // 题目字符串分配在返回的题库自带的内存区中；题库文件表的第 i 项即 paths[i]
+    // dedup 为 true 时在加载过程中跨文件去重 (只保留按文件顺序第一次出现的题目)，各文件丢弃的数量记在文件表中
+    // stop 被请求后不再开始新的文件，返回已完成的部分
+    question_bank load_files(const std::vector<std::string> & paths, const text_parser & parser, const parse_cache * cache = nullptr,
+                             bool dedup = false, std::stop_token stop = {}, const file_done_callback & on_file_done = {});
+
+    // 并行只读扫描多个文件，视图按 paths 的顺序合并 (与 load_files 的题目一一对应)
+    question_view_list view_files(const std::vector<std::string> & paths, const text_parser & parser,
+                                  std::stop_token stop = {}, const file_done_callback & on_file_done = {});
+};
@@ -0,0 +1,20 @@
+﻿#include "dedup_set.h"
+
+bool dedup_set::claim(size_t id, uint64_t order)
+{
+    shard & s = shard_of(id);
+    std::lock_guard lock(s.mutex);
+    auto [it, inserted] = s.first.try_emplace(id, order);
+    if(inserted) return true;
+    if(order > it->second) return false;
+    it->second = order;
+    return true;
+}
+
+bool dedup_set::owns(size_t id, uint64_t order) const
+{
+    const shard & s = shard_of(id);
+    std::lock_guard lock(s.mutex);
+    auto it = s.first.find(id);
+    return it != s.first.end() && it->second == order;
+}
@@ -0,0 +1,40 @@
+﻿#pragma once
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+// 跨文件去重用的并发 ID 集合: 按 ID 分成若干分片，每个分片一把锁，并行解析的各文件可以同时登记
+// 每个 ID 记住目前见到的最靠前的出现位置，因此最终保留的总是按文件顺序第一次出现的题目，与线程完成的先后无关
+class dedup_set
+{
+public:
+    static constexpr size_t shard_count = 64;
+
+    // 出现位置: 文件在加载列表中的下标 (高 24 位) + 题目块在文件中的字节偏移 (低 40 位)，数值越小越靠前
+    static uint64_t order_of(size_t file_index, uint64_t block_offset)
+    {
+        return (static_cast<uint64_t>(file_index) << 40) | (block_offset & ((uint64_t{ 1 } << 40) - 1));
+    }
+
+    // 登记一次出现；已有更靠前的出现时返回 false (确定是重复，可以立即丢弃)
+    // 返回 true 只表示暂时保留: 之后可能还会登记更靠前的出现，最终以 owns() 为准
+    bool claim(size_t id, uint64_t order);
+
+    // 全部登记完成后调用: 该出现是否就是最靠前的那一次
+    bool owns(size_t id, uint64_t order) const;
+
+private:
+    struct alignas(64) shard
+    {
+        mutable std::mutex mutex;
+        std::unordered_map<size_t, uint64_t> first;   // ID -> 最靠前的出现位置
+    };
+
+    // ID 是 FNV 哈希，低位已足够分散
+    shard & shard_of(size_t id) { return shards_[id % shard_count]; }
+    const shard & shard_of(size_t id) const { return shards_[id % shard_count]; }
+
+    std::array<shard, shard_count> shards_;
+};
@@ -0,0 +1,319 @@
+﻿#include "encoding_utils.h"
+#include "gb18030_table.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include <QDebug>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define ENCODING_UTILS_SSE2
+    #include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define ENCODING_UTILS_NEON
+    #include <arm_neon.h>
+#endif
+
+namespace
+{
+    // 16 字节是否全部是 ASCII
+    inline bool is_ascii16(const unsigned char * p)
+    {
+#if defined(ENCODING_UTILS_SSE2)
+        return _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))) == 0;
+#elif defined(ENCODING_UTILS_NEON)
+        return vmaxvq_u8(vld1q_u8(p)) < 0x80;
+#else
+        uint64_t a, b;
+        std::memcpy(&a, p, 8);
+        std::memcpy(&b, p + 8, 8);
+        return ((a | b) & 0x8080808080808080ull) == 0;
+#endif
+    }
+
+    bool is_continuation(unsigned char c) { return (c & 0xC0) == 0x80; }
+
+    void append_utf8(std::string & out, uint32_t cp)
+    {
+        if(cp < 0x80)
+        {
+            out.push_back(static_cast<char>(cp));
+        }
+        else if(cp < 0x800)
+        {
+            const char bytes[2]{ static_cast<char>(0xC0 | (cp >> 6)), static_cast<char>(0x80 | (cp & 0x3F)) };
+            out.append(bytes, 2);
+        }
+        else if(cp < 0x10000)
+        {
+            const char bytes[3]{ static_cast<char>(0xE0 | (cp >> 12)), static_cast<char>(0x80 | ((cp >> 6) & 0x3F)),
+                                 static_cast<char>(0x80 | (cp & 0x3F)) };
+            out.append(bytes, 3);
+        }
+        else
+        {
+            const char bytes[4]{ static_cast<char>(0xF0 | (cp >> 18)), static_cast<char>(0x80 | ((cp >> 12) & 0x3F)),
+                                 static_cast<char>(0x80 | ((cp >> 6) & 0x3F)), static_cast<char>(0x80 | (cp & 0x3F)) };
+            out.append(bytes, 4);
+        }
+    }
+
+    // GB18030 四字节序列 (各字节范围已校验) 对应的码点
+    uint32_t gb18030_four_byte(const unsigned char * p)
+    {
+        const uint32_t index = ((p[0] - 0x81u) * 10 + (p[1] - 0x30u)) * 1260 + (p[2] - 0x81u) * 10 + (p[3] - 0x30u);
+        if(index < gb18030_table::bmp_index_count)
+        {
+            // 第一段从序号 0 开始，upper_bound 的前一段就是 index 所在的段
+            auto it = std::ranges::upper_bound(gb18030_table::bmp_ranges, index, {}, &gb18030_table::range::index);
+            --it;
+            return it->unicode + (index - it->index);
+        }
+
+        // 辅助平面: 90308130 起线性对应 U+10000..U+10FFFF
+        constexpr uint32_t supplementary_index = (0x90 - 0x81) * 12600;
+        if(index >= supplementary_index && index - supplementary_index <= 0xFFFFF) return 0x10000 + (index - supplementary_index);
+        return 0xFFFD;
+    }
+
+    // 查表把 GB18030 转成 UTF-8 追加到 out，返回处理的字节数 (末尾被截断的序列不处理，留给下一块)
+    size_t decode_gb18030(std::string_view bytes, std::string & out)
+    {
+        const auto * p = reinterpret_cast<const unsigned char *>(bytes.data());
+        const size_t n = bytes.size();
+        size_t i = 0;
+
+        while(i < n)
+        {
+            // ASCII 一段一段地整体复制
+            size_t ascii = i;
+            while(ascii + 16 <= n && is_ascii16(p + ascii)) ascii += 16;
+            while(ascii < n && p[ascii] < 0x80) ++ascii;
+            if(ascii > i)
+            {
+                out.append(bytes.data() + i, ascii - i);
+                i = ascii;
+                continue;
+            }
+
+            const unsigned char c = p[i];
+            if(c == 0x80 || c == 0xFF)
+            {
+                append_utf8(out, 0xFFFD);
+                ++i;
+                continue;
+            }
+            if(i + 1 >= n) break;
+
+            const unsigned char c2 = p[i + 1];
+            if(c2 >= 0x40 && c2 <= 0xFE && c2 != 0x7F)
+            {
+                append_utf8(out, gb18030_table::two_byte[(c - 0x81) * gb18030_table::trail_count + (c2 - 0x40)]);
+                i += 2;
+                continue;
+            }
+            if(c2 >= 0x30 && c2 <= 0x39)
+            {
+                const bool third_ok = i + 2 >= n || (p[i + 2] >= 0x81 && p[i + 2] <= 0xFE);
+                if(third_ok && i + 3 >= n) break;
+                if(third_ok && p[i + 3] >= 0x30 && p[i + 3] <= 0x39)
+                {
+                    append_utf8(out, gb18030_four_byte(p + i));
+                    i += 4;
+                    continue;
+                }
+            }
+
+            // 无效序列: 只跳过首字节，后面的字节 (可能是 ASCII) 重新判断
+            append_utf8(out, 0xFFFD);
+            ++i;
+        }
+        return i;
+    }
+}
+
+bool encoding_utils::is_valid_utf8(std::string_view bytes, bool allow_truncated_tail)
+{
+    const auto * p = reinterpret_cast<const unsigned char *>(bytes.data());
+    const size_t n = bytes.size();
+    size_t i = 0;
+
+    while(i < n)
+    {
+        // ASCII 快速路径
+        if(i + 16 <= n && is_ascii16(p + i))
+        {
+            i += 16;
+            continue;
+        }
+
+        unsigned char c = p[i];
+        if(c < 0x80)
+        {
+            ++i;
+            continue;
+        }
+
+        // 多字节序列: 确定长度和第二个字节的合法范围
+        size_t length = 0;
+        unsigned char lo = 0x80, hi = 0xBF;
+        if(c >= 0xC2 && c <= 0xDF) length = 2;
+        else if(c == 0xE0) { length = 3; lo = 0xA0; }
+        else if(c == 0xED) { length = 3; hi = 0x9F; }          // 排除代理区 U+D800..U+DFFF
+        else if(c >= 0xE1 && c <= 0xEF) length = 3;
+        else if(c == 0xF0) { length = 4; lo = 0x90; }
+        else if(c == 0xF4) { length = 4; hi = 0x8F; }          // 不超过 U+10FFFF
+        else if(c >= 0xF1 && c <= 0xF3) length = 4;
+        else return false;
+
+        for(size_t k = 1; k < length; ++k)
+        {
+            if(i + k >= n) return allow_truncated_tail;
+            unsigned char t = p[i + k];
+            if(k == 1 ? (t < lo || t > hi) : !is_continuation(t)) return false;
+        }
+        i += length;
+    }
+    return true;
+}
+
+size_t encoding_utils::truncated_utf8_tail(std::string_view bytes)
+{
+    // 从末尾向前找最后一个首字节，看它的序列是否完整
+    const size_t n = bytes.size();
+    for(size_t k = 1; k <= std::min<size_t>(3, n); ++k)
+    {
+        unsigned char c = static_cast<unsigned char>(bytes[n - k]);
+        if(is_continuation(c)) continue;
+
+        size_t length = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 1;
+        return length > k ? k : 0;
+    }
+    return 0;
+}
+
+encoding_utils::text_encoding encoding_utils::detect(std::string_view bytes, bool partial)
+{
+    if(bytes.starts_with("\xEF\xBB\xBF")) return text_encoding::utf8;
+    if(bytes.starts_with("\xFF\xFE")) return text_encoding::utf16le;
+    if(bytes.starts_with("\xFE\xFF")) return text_encoding::utf16be;
+
+    if(is_valid_utf8(bytes, partial)) return text_encoding::utf8;
+
+    // 只取开头一段做启发式判断，足以区分编码
+    std::string_view sample = bytes.substr(0, 64 * 1024);
+    const auto * p = reinterpret_cast<const unsigned char *>(sample.data());
+    const size_t n = sample.size();
+
+    // 无 BOM 的 UTF-16: 中英混排文本中大量 ASCII 字符的高字节为 0
+    size_t zero_even = 0, zero_odd = 0;
+    for(size_t i = 0; i < n; ++i)
+    {
+        if(p[i] == 0) (i % 2 == 0 ? zero_even : zero_odd)++;
+    }
+    if(zero_odd > n / 8 && zero_even < zero_odd / 8) return text_encoding::utf16le;
+    if(zero_even > n / 8 && zero_odd < zero_even / 8) return text_encoding::utf16be;
+
+    // GB18030: 双字节 (81-FE, 40-FE 且非 7F) 或四字节 (81-FE, 30-39, 81-FE, 30-39)
+    size_t valid = 0, invalid = 0;
+    for(size_t i = 0; i < n; )
+    {
+        unsigned char c = p[i];
+        if(c < 0x80) { ++i; continue; }
+        if(c == 0x80 || c == 0xFF) { ++invalid; ++i; continue; }
+        if(i + 1 >= n) break; // 末尾被截断
+
+        unsigned char c2 = p[i + 1];
+        if(c2 >= 0x40 && c2 <= 0xFE && c2 != 0x7F)
+        {
+            ++valid;
+            i += 2;
+        }
+        else if(c2 >= 0x30 && c2 <= 0x39 && i + 3 < n && p[i + 2] >= 0x81 && p[i + 2] <= 0xFE && p[i + 3] >= 0x30 && p[i + 3] <= 0x39)
+        {
+            ++valid;
+            i += 4;
+        }
+        else
+        {
+            ++invalid;
+            ++i;
+        }
+    }
+    // 容忍极少量损坏的字节
+    if(valid > 0 && invalid * 100 <= valid) return text_encoding::gb18030;
+
+    return text_encoding::utf8;
+}
+
+encoding_utils::text_decoder::text_decoder(text_encoding encoding) : encoding_(encoding)
+{
+    switch(encoding)
+    {
+        case text_encoding::utf16le: qt_decoder_.emplace(QStringConverter::Utf16LE); break;
+        case text_encoding::utf16be: qt_decoder_.emplace(QStringConverter::Utf16BE); break;
+        default: break;
+    }
+}
+
+bool encoding_utils::text_decoder::is_valid() const
+{
+    return !qt_decoder_ || qt_decoder_->isValid();
+}
+
+void encoding_utils::text_decoder::decode(std::string_view bytes, std::string & out)
+{
+    if(qt_decoder_)
+    {
+        // QStringDecoder 默认会去掉 BOM
+        const QByteArray utf8 = qt_decoder_->decode(QByteArrayView(bytes.data(), static_cast<qsizetype>(bytes.size()))).toUtf8();
+        out.append(utf8.constData(), static_cast<size_t>(utf8.size()));
+        return;
+    }
+    if(encoding_ != text_encoding::gb18030)
+    {
+        out.append(bytes);
+        return;
+    }
+
+    // GBK 的汉字 2 字节转成 UTF-8 的 3 字节
+    out.reserve(out.size() + bytes.size() + bytes.size() / 2);
+
+    // 上一块留下的不完整序列接上本块开头的 4 个字节一起解码 (序列最长 4 字节，足以越过留下的部分)
+    if(!pending_.empty())
+    {
+        const size_t carried = pending_.size();
+        pending_.append(bytes.substr(0, 4));
+        const size_t used = decode_gb18030(pending_, out);
+        if(used < carried)
+        {
+            // 本块不足 4 字节，已全部并入 pending_ 仍不完整
+            pending_.erase(0, used);
+            return;
+        }
+        bytes.remove_prefix(used - carried);
+        pending_.clear();
+    }
+
+    const size_t used = decode_gb18030(bytes, out);
+    pending_.assign(bytes.substr(used));
+}
+
+bool encoding_utils::to_utf8(std::string_view bytes, std::optional<std::string> & out)
+{
+    out.reset();
+    text_encoding encoding = detect(bytes);
+    if(encoding == text_encoding::utf8) return true;
+
+    text_decoder decoder(encoding);
+    if(!decoder.is_valid())
+    {
+        qWarning() << "Unsupported text encoding";
+        return false;
+    }
+
+    out.emplace();
+    decoder.decode(bytes, *out);
+    return true;
+}
@@ -0,0 +1,53 @@
+﻿#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <QStringDecoder>
+
+// 题库文本编码: 检测 UTF-8 / UTF-16 / GBK(GB18030)，非 UTF-8 的文件转码后再交给解析器
+namespace encoding_utils
+{
+    enum class text_encoding
+    {
+        utf8,
+        utf16le,
+        utf16be,
+        gb18030,  // 兼容 GBK / GB2312
+    };
+
+    // 严格校验 UTF-8 (拒绝过长编码、代理区和超出 U+10FFFF 的码点)
+    // ASCII 部分按 16 字节 SIMD 批量跳过；allow_truncated_tail 为 true 时允许末尾有被截断的多字节序列 (分块读取时使用)
+    bool is_valid_utf8(std::string_view bytes, bool allow_truncated_tail = false);
+
+    // 末尾被截断的多字节序列的字节数 (0..3)；bytes 应已通过 is_valid_utf8(bytes, true) 校验
+    size_t truncated_utf8_tail(std::string_view bytes);
+
+    // 检测编码: 优先看 BOM，其次校验 UTF-8，最后用启发式规则判断 UTF-16 (无 BOM) 和 GB18030
+    // 无法判断时按 UTF-8 处理 (与以前的行为相同)
+    text_encoding detect(std::string_view bytes, bool partial = false);
+
+    // 转为 UTF-8 的解码器 (有状态，可以跨块解码: 被截断的多字节字符留到下一块)
+    // GB18030 / GBK 用内置映射表 (gb18030_table) 直接转成 UTF-8，不经过 QString，也不依赖 Qt 的 ICU 后端；UTF-16 交给 QStringDecoder
+    class text_decoder
+    {
+    public:
+        explicit text_decoder(text_encoding encoding);
+
+        // 平台不支持该编码时为 false，此时不应再把内容当作 UTF-8 解析
+        bool is_valid() const;
+
+        // 解码 bytes，结果追加到 out；无效的字节序列替换为 U+FFFD
+        void decode(std::string_view bytes, std::string & out);
+
+    private:
+        text_encoding encoding_;
+        std::optional<QStringDecoder> qt_decoder_;
+        std::string pending_;   // GB18030: 上一块末尾不完整的序列 (最多 3 字节)
+    };
+
+    // 非 UTF-8 文本转码为 UTF-8 存入 out 并返回 true；已经是 UTF-8 时 out 为空 (调用方直接使用原数据，不产生拷贝)
+    // 检测出的编码无法解码时返回 false，调用方应把文件当作读取失败，而不是按 UTF-8 误解析
+    bool to_utf8(std::string_view bytes, std::optional<std::string> & out);
+};
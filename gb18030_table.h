@@ -0,0 +1,27 @@
+﻿#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// GB18030 (按 GB18030-2005，兼容 GBK / GB2312) 到 Unicode 的映射表，供 encoding_utils 的内置解码器查表转码
+// 不依赖 Qt 的 ICU 后端: Android 等没有 ICU 的平台上同样能转码
+namespace gb18030_table
+{
+    // 双字节: 首字节 0x81..0xFE，尾字节 0x40..0xFE，下标为 (首字节 - 0x81) * trail_count + (尾字节 - 0x40)
+    // 尾字节 0x7F 等无效组合为 U+FFFD
+    inline constexpr size_t lead_count = 126;
+    inline constexpr size_t trail_count = 191;
+    extern const std::array<uint16_t, lead_count * trail_count> two_byte;
+
+    // 四字节中属于 BMP 的部分 (81308130..8431A439) 按序号分段，段内码点连续递增
+    // 序号 = ((b1 - 0x81) * 10 + (b2 - 0x30)) * 1260 + (b3 - 0x81) * 10 + (b4 - 0x30)
+    struct range
+    {
+        uint32_t index;     // 段内第一个序列的序号
+        uint16_t unicode;   // 对应的码点
+    };
+    inline constexpr uint32_t bmp_index_count = 39420;
+    inline constexpr size_t bmp_range_count = 208;
+    extern const std::array<range, bmp_range_count> bmp_ranges;
+}
@@ -0,0 +1,178 @@
+﻿#include "history_log.h"
+#include "platform_utils.h"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <optional>
+
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+
+namespace
+{
+    // 定长记录 (本机字节序)；日期固定为 "yyyy-MM-dd HH:mm"，按 24 字节保存，不足补 0
+    struct record
+    {
+        char date[24];
+        double score;
+        double total_score;
+        int32_t duration_sec;
+        int32_t correct_count;
+        int32_t total_count;
+        uint32_t reserved;
+    };
+    static_assert(sizeof(record) == 56);
+
+    record to_record(const exam_record & r)
+    {
+        record rec{};
+        std::memcpy(rec.date, r.date.data(), std::min(r.date.size(), sizeof(rec.date)));
+        rec.score = r.score;
+        rec.total_score = r.total_score;
+        rec.duration_sec = r.duration_sec;
+        rec.correct_count = r.correct_count;
+        rec.total_count = r.total_count;
+        return rec;
+    }
+
+    exam_record from_record(const record & rec, const std::string & repo_name)
+    {
+        exam_record r;
+        r.repo_name = repo_name;
+        r.date.assign(rec.date, strnlen(rec.date, sizeof(rec.date)));
+        r.score = rec.score;
+        r.total_score = rec.total_score;
+        r.duration_sec = rec.duration_sec;
+        r.correct_count = rec.correct_count;
+        r.total_count = rec.total_count;
+        return r;
+    }
+
+    // 文件头: 魔数、版本、题库名长度和题库名，之后紧跟记录
+    // 校验通过时返回题库名，file 停在第一条记录处
+    std::optional<std::string> read_header(QFile & file, uint32_t magic, uint32_t version)
+    {
+        uint32_t header[3]{};
+        if(file.read(reinterpret_cast<char *>(header), sizeof(header)) != sizeof(header)) return std::nullopt;
+        if(header[0] != magic || header[1] != version || header[2] > 4096) return std::nullopt;
+
+        std::string name(header[2], '\0');
+        if(file.read(name.data(), header[2]) != static_cast<qint64>(header[2])) return std::nullopt;
+        return name;
+    }
+
+    QByteArray header_bytes(const std::string & repo_name, uint32_t magic, uint32_t version)
+    {
+        const uint32_t header[3]{ magic, version, static_cast<uint32_t>(repo_name.size()) };
+        QByteArray bytes(reinterpret_cast<const char *>(header), sizeof(header));
+        bytes.append(repo_name.data(), static_cast<qsizetype>(repo_name.size()));
+        return bytes;
+    }
+}
+
+std::filesystem::path history_log::log_path(const std::string & repo_name) const
+{
+    return dir_ / std::format("{:016x}.log", stable_hash(repo_name));
+}
+
+bool history_log::append(const exam_record & record_in) const
+{
+    QDir().mkpath(platform_utils::to_q_path(dir_));
+
+    QFile file(platform_utils::to_q_path(log_path(record_in.repo_name)));
+    if(!file.open(QIODevice::ReadWrite)) return false;
+
+    if(file.size() == 0)
+    {
+        file.write(header_bytes(record_in.repo_name, magic, format_version));
+    }
+    else
+    {
+        // 题库名哈希碰撞或文件损坏时不写入
+        auto name = read_header(file, magic, format_version);
+        if(name != record_in.repo_name) return false;
+
+        // 截掉末尾不完整的记录 (写入时崩溃)，保证记录号能直接定位
+        const qint64 data_offset = file.pos();
+        const qint64 end = data_offset + (file.size() - data_offset) / static_cast<qint64>(sizeof(record)) * sizeof(record);
+        if(end != file.size()) file.resize(end);
+        file.seek(end);
+    }
+
+    const record rec = to_record(record_in);
+    return file.write(reinterpret_cast<const char *>(&rec), sizeof(rec)) == sizeof(rec);
+}
+
+bool history_log::replace(const std::string & repo_name, const std::vector<exam_record> & records) const
+{
+    QDir().mkpath(platform_utils::to_q_path(dir_));
+    const QString path = platform_utils::to_q_path(log_path(repo_name));
+
+    {
+        QFile existing(path);
+        if(existing.open(QIODevice::ReadOnly) && existing.size() > 0 && read_header(existing, magic, format_version) != repo_name) return false;
+    }
+
+    QByteArray data = header_bytes(repo_name, magic, format_version);
+    data.reserve(data.size() + static_cast<qsizetype>(records.size() * sizeof(record)));
+    for(const auto & r : records)
+    {
+        const record rec = to_record(r);
+        data.append(reinterpret_cast<const char *>(&rec), sizeof(rec));
+    }
+
+    QSaveFile file(path);
+    if(!file.open(QIODevice::WriteOnly) || file.write(data) != data.size()) return false;
+    return file.commit();
+}
+
+size_t history_log::count(const std::string & repo_name) const
+{
+    QFile file(platform_utils::to_q_path(log_path(repo_name)));
+    if(!file.open(QIODevice::ReadOnly)) return 0;
+    if(read_header(file, magic, format_version) != repo_name) return 0;
+
+    return static_cast<size_t>((file.size() - file.pos()) / static_cast<qint64>(sizeof(record)));
+}
+
+std::vector<exam_record> history_log::read(const std::string & repo_name, size_t offset, size_t limit, size_t upto) const
+{
+    std::vector<exam_record> list;
+
+    QFile file(platform_utils::to_q_path(log_path(repo_name)));
+    if(!file.open(QIODevice::ReadOnly)) return list;
+    if(read_header(file, magic, format_version) != repo_name) return list;
+
+    // 记录按时间顺序追加，最新的在文件末尾: 第 offset 新的记录之前的 limit 条就是这一页
+    const qint64 data_offset = file.pos();
+    const size_t total = std::min(upto, static_cast<size_t>((file.size() - data_offset) / static_cast<qint64>(sizeof(record))));
+    if(offset >= total) return list;
+
+    const size_t last = total - offset;                   // 这一页最新记录之后的记录号
+    const size_t first = last - std::min(limit, last);    // 这一页最旧记录的记录号
+
+    std::vector<record> page(last - first);
+    file.seek(data_offset + static_cast<qint64>(first * sizeof(record)));
+    const qint64 bytes = static_cast<qint64>(page.size() * sizeof(record));
+    if(file.read(reinterpret_cast<char *>(page.data()), bytes) != bytes) return list;
+
+    list.reserve(page.size());
+    for(auto it = page.rbegin(); it != page.rend(); ++it) list.push_back(from_record(*it, repo_name));
+    return list;
+}
+
+std::vector<std::string> history_log::repo_names() const
+{
+    std::vector<std::string> names;
+
+    QDir dir(platform_utils::to_q_path(dir_));
+    for(const QString & entry : dir.entryList({ "*.log" }, QDir::Files))
+    {
+        QFile file(dir.filePath(entry));
+        if(!file.open(QIODevice::ReadOnly)) continue;
+        if(auto name = read_header(file, magic, format_version)) names.push_back(std::move(*name));
+    }
+    return names;
+}
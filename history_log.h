@@ -0,0 +1,39 @@
+﻿#pragma once
+
+#include "question.h"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// 考试历史的追加式日志: 每个题库一个文件 (history/<题库名哈希>.log)，记录为定长二进制
+// 新记录只在文件末尾追加；读取时按记录号直接定位，从最新一条开始分页
+class history_log
+{
+public:
+    history_log() = default;
+    explicit history_log(std::filesystem::path dir) : dir_(std::move(dir)) {}
+
+    bool append(const exam_record & record) const;
+
+    // 整体重写题库的日志 (按时间顺序)，写完才替换原文件；原文件属于别的题库 (名字哈希碰撞) 时不写入
+    bool replace(const std::string & repo_name, const std::vector<exam_record> & records) const;
+
+    // 题库的记录总数
+    size_t count(const std::string & repo_name) const;
+
+    // 从最新一条往前数，跳过 offset 条后最多读 limit 条 (结果为最新在前)
+    // upto: 只看前 upto 条记录，之后追加的视为不存在 (与读取时另外取得的记录数保持一致)
+    std::vector<exam_record> read(const std::string & repo_name, size_t offset = 0, size_t limit = SIZE_MAX, size_t upto = SIZE_MAX) const;
+
+    // 所有有记录的题库名 (文件头中保存)
+    std::vector<std::string> repo_names() const;
+
+private:
+    static constexpr uint32_t magic = 0x48485150; // "PQHH"
+    static constexpr uint32_t format_version = 1;
+
+    std::filesystem::path log_path(const std::string & repo_name) const;
+
+    std::filesystem::path dir_;
+};
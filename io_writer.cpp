@@ -0,0 +1,169 @@
+﻿#include "io_writer.h"
+#include "platform_utils.h"
+
+#include <algorithm>
+
+#include <QDebug>
+#include <QFile>
+#include <QHash>
+#include <QSaveFile>
+
+io_writer::io_writer() : head_(new job), tail_(head_.load())
+{
+    thread_ = std::jthread([this] { run(); });
+}
+
+io_writer::~io_writer()
+{
+    stopping_.store(true, std::memory_order_release);
+    signal_.fetch_add(1, std::memory_order_release);
+    signal_.notify_one();
+    if(thread_.joinable()) thread_.join();
+
+    delete tail_; // 剩下的哨兵节点
+}
+
+void io_writer::push(work item)
+{
+    auto * j = new job{ std::move(item) };
+
+    // 先交换队头，再把前一个节点接上；消费者可能短暂看到链表在这里断开，此时当作队列为空，由 signal_ 再唤醒
+    job * prev = head_.exchange(j, std::memory_order_acq_rel);
+    prev->next.store(j, std::memory_order_release);
+
+    signal_.fetch_add(1, std::memory_order_release);
+    signal_.notify_one();
+}
+
+bool io_writer::pop(work & out)
+{
+    job * next = tail_->next.load(std::memory_order_acquire);
+    if(!next) return false;
+
+    // next 成为新的哨兵: 取走它的内容，释放旧哨兵
+    out = std::move(next->item);
+    delete tail_;
+    tail_ = next;
+    return true;
+}
+
+void io_writer::write_file(const std::filesystem::path & path, QByteArray content)
+{
+    push({ work::kind::write_file, platform_utils::to_q_path(path), std::move(content) });
+}
+
+void io_writer::append(const std::filesystem::path & path, QByteArray bytes)
+{
+    push({ work::kind::append, platform_utils::to_q_path(path), std::move(bytes) });
+}
+
+void io_writer::post(std::function<void()> task)
+{
+    push({ work::kind::task, {}, {}, std::move(task) });
+}
+
+void io_writer::flush()
+{
+    std::promise<void> done;
+    std::future<void> finished = done.get_future();
+    push({ work::kind::barrier, {}, {}, {}, &done });
+    finished.wait();
+}
+
+void io_writer::run()
+{
+    std::vector<work> batch;
+    for(;;)
+    {
+        const uint32_t seen = signal_.load(std::memory_order_acquire);
+
+        work item;
+        while(pop(item)) batch.push_back(std::move(item));
+        if(!batch.empty())
+        {
+            process(batch);
+            batch.clear();
+            continue;
+        }
+
+        // 队列已空: 析构请求时退出，否则等待新的入队
+        if(stopping_.load(std::memory_order_acquire)) return;
+        signal_.wait(seen, std::memory_order_acquire);
+    }
+}
+
+void io_writer::process(std::vector<work> & batch)
+{
+    // 同一文件的整文件写入只保留最后一次；合并不跨越 task / barrier，保证 flush 返回时此前的内容都已落盘
+    std::vector<bool> superseded(batch.size(), false);
+    QHash<QString, size_t> last_write;
+    for(size_t i = 0; i < batch.size(); ++i)
+    {
+        const work & w = batch[i];
+        if(w.type == work::kind::task || w.type == work::kind::barrier)
+        {
+            last_write.clear();
+        }
+        else if(w.type == work::kind::write_file)
+        {
+            if(auto it = last_write.find(w.path); it != last_write.end()) superseded[*it] = true;
+            last_write[w.path] = i;
+        }
+    }
+
+    // 追加按文件攒起来，遇到 task / barrier 或这一批结束时每个文件一次写入
+    // 整体写入同一文件前先写掉它攒着的追加，保持提交顺序
+    std::vector<std::pair<QString, QByteArray>> appends;
+    auto append_to = [](const QString & path, const QByteArray & bytes)
+        {
+            QFile file(path);
+            if(!file.open(QIODevice::WriteOnly | QIODevice::Append) || file.write(bytes) != bytes.size())
+            {
+                qWarning() << "Failed to append to" << path;
+            }
+        };
+    auto write_appends = [&]
+        {
+            for(auto & [path, bytes] : appends) append_to(path, bytes);
+            appends.clear();
+        };
+
+    for(size_t i = 0; i < batch.size(); ++i)
+    {
+        work & w = batch[i];
+        switch(w.type)
+        {
+        case work::kind::write_file:
+            if(auto it = std::ranges::find(appends, w.path, &std::pair<QString, QByteArray>::first); it != appends.end())
+            {
+                append_to(it->first, it->second);
+                appends.erase(it);
+            }
+            if(!superseded[i])
+            {
+                QSaveFile file(w.path);
+                if(!file.open(QIODevice::WriteOnly) || file.write(w.data) != w.data.size() || !file.commit())
+                {
+                    qWarning() << "Failed to write" << w.path;
+                }
+            }
+            break;
+        case work::kind::append:
+        {
+            auto it = std::ranges::find(appends, w.path, &std::pair<QString, QByteArray>::first);
+            if(it == appends.end()) appends.emplace_back(std::move(w.path), std::move(w.data));
+            else it->second += w.data;
+            break;
+        }
+        case work::kind::task:
+            write_appends();
+            w.task();
+            break;
+        case work::kind::barrier:
+            write_appends();
+            w.done->set_value();
+            break;
+        }
+    }
+    write_appends();
+}
@@ -0,0 +1,70 @@
+﻿#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include <QByteArray>
+#include <QString>
+
+// 后台写盘线程 (write-behind): GUI 线程只把写入任务放进无锁队列就返回，磁盘速度不再影响界面响应
+// 队列为多生产者单消费者的侵入式链表 (Vyukov MPSC)，入队只有一次原子交换；写盘线程每次取出所有排队任务成批处理:
+//   - 同一文件的整文件写入只执行最后一次
+//   - 同一文件的追加合并为一次写入
+// 析构时先写完队列中的全部任务再退出
+class io_writer
+{
+public:
+    io_writer();
+    ~io_writer();
+
+    io_writer(const io_writer &) = delete;
+    io_writer & operator=(const io_writer &) = delete;
+
+    // 整文件替换 (QSaveFile 先写临时文件再替换)
+    void write_file(const std::filesystem::path & path, QByteArray content);
+
+    // 追加到文件末尾 (文件不存在时创建)
+    void append(const std::filesystem::path & path, QByteArray bytes);
+
+    // 其他写操作，与前面的任务按提交顺序执行
+    void post(std::function<void()> task);
+
+    // 屏障: 阻塞直到此前提交的所有任务都已执行 (不能在写盘线程中调用)
+    void flush();
+
+private:
+    struct work
+    {
+        enum class kind : uint8_t { write_file, append, task, barrier };
+
+        kind type = kind::task;
+        QString path;
+        QByteArray data;
+        std::function<void()> task;
+        std::promise<void> * done = nullptr;    // barrier: flush() 的调用者在栈上等待
+    };
+
+    struct job
+    {
+        work item;
+        std::atomic<job *> next{ nullptr };
+    };
+
+    void push(work item);
+    bool pop(work & out);   // 只由写盘线程调用；队列暂时为空时返回 false
+
+    void run();
+    void process(std::vector<work> & batch);
+
+    std::atomic<job *> head_;       // 生产者在这里入队
+    job * tail_;                    // 消费者从这里出队 (总指向已出队的哨兵节点)
+    std::atomic<uint32_t> signal_{ 0 };     // 入队计数，写盘线程在上面等待
+    std::atomic<bool> stopping_{ false };
+
+    std::jthread thread_;           // 最后声明: 其余成员初始化完成后才启动
+};
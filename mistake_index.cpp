@@ -0,0 +1,90 @@
+﻿#include "mistake_index.h"
+#include "platform_utils.h"
+
+#include <algorithm>
+#include <bit>
+#include <vector>
+
+#include <QSaveFile>
+
+bool mistake_index::open(const std::filesystem::path & path)
+{
+    close();
+
+    auto file = std::make_unique<QFile>(platform_utils::to_q_path(path));
+    if(!file->open(QIODevice::ReadOnly)) return false;
+
+    const qint64 size = file->size();
+    if(size < static_cast<qint64>(sizeof(header))) return false;
+
+    const uchar * mapped = file->map(0, size);
+    if(!mapped) return false;
+
+    // 映射从页边界开始，头部和槽都是自然对齐的
+    const auto * h = reinterpret_cast<const header *>(mapped);
+    if(h->magic != magic || h->version != format_version) return false;
+    if(h->capacity < 2 || !std::has_single_bit(h->capacity) || h->count >= h->capacity) return false;
+    if(static_cast<uint64_t>(size) != sizeof(header) + h->capacity * sizeof(slot)) return false;
+
+    file_ = std::move(file);
+    header_ = h;
+    slots_ = reinterpret_cast<const slot *>(mapped + sizeof(header));
+    shift_ = 64 - std::countr_zero(h->capacity);
+    return true;
+}
+
+void mistake_index::close()
+{
+    header_ = nullptr;
+    slots_ = nullptr;
+    shift_ = 64;
+    file_.reset(); // QFile 析构时解除映射
+}
+
+uint32_t mistake_index::find(size_t id) const
+{
+    if(!header_) return 0;
+
+    // 正常的索引至少有一半空槽；探测步数仍以容量为上限，损坏的文件 (没有空槽) 不会让查找死循环
+    const uint64_t mask = header_->capacity - 1;
+    uint64_t i = home_of(id, shift_);
+    for(uint64_t step = 0; step < header_->capacity; ++step, i = (i + 1) & mask)
+    {
+        const slot & s = slots_[i];
+        if(s.count == 0) return 0;
+        if(s.id == id) return s.count;
+    }
+    return 0;
+}
+
+bool mistake_index::write(const std::filesystem::path & path, const std::unordered_map<size_t, size_t> & counts, uint64_t generation)
+{
+    size_t count = 0;
+    uint32_t max_count = 0;
+    for(const auto & [id, n] : counts)
+    {
+        if(n == 0) continue;
+        ++count;
+        max_count = std::max(max_count, static_cast<uint32_t>(n));
+    }
+
+    const uint64_t capacity = std::bit_ceil(std::max<uint64_t>(16, count * 2));
+    const int shift = 64 - std::countr_zero(capacity);
+    std::vector<slot> slots(capacity, slot{});
+    for(const auto & [id, n] : counts)
+    {
+        if(n == 0) continue;
+        uint64_t i = home_of(id, shift);
+        while(slots[i].count != 0) i = (i + 1) & (capacity - 1);
+        slots[i] = { id, static_cast<uint32_t>(n), 0 };
+    }
+
+    const header h{ magic, format_version, generation, capacity, static_cast<uint32_t>(count), max_count };
+
+    // 先写临时文件再替换，写入中途退出不会留下半截的索引
+    QSaveFile file(platform_utils::to_q_path(path));
+    if(!file.open(QIODevice::WriteOnly)) return false;
+    file.write(reinterpret_cast<const char *>(&h), sizeof(h));
+    file.write(reinterpret_cast<const char *>(slots.data()), static_cast<qint64>(slots.size() * sizeof(slot)));
+    return file.commit();
+}
@@ -0,0 +1,72 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <unordered_map>
+
+#include <QFile>
+
+// 错题次数的二进制索引: 固定布局的开放寻址哈希表 (线性探测)，启动时只读映射，查询直接在映射内存上进行
+// 文件 = 头部 + capacity 个槽；capacity 为 2 的幂，装载率不超过 1/2
+class mistake_index
+{
+public:
+    struct slot
+    {
+        uint64_t id;
+        uint32_t count;     // 0 表示空槽
+        uint32_t reserved;  // 对齐到 16 字节
+    };
+
+    mistake_index() = default;
+    mistake_index(const mistake_index &) = delete;
+    mistake_index & operator=(const mistake_index &) = delete;
+
+    // 映射索引文件 (先关闭之前的映射)；文件不存在或格式不符时返回 false，索引为空
+    bool open(const std::filesystem::path & path);
+    void close();
+
+    // 题目的错误次数，不在索引中返回 0
+    uint32_t find(size_t id) const;
+
+    size_t size() const { return header_ ? header_->count : 0; }
+    uint32_t max_count() const { return header_ ? header_->max_count : 0; }
+    uint64_t generation() const { return header_ ? header_->generation : 0; }
+
+    template<typename Fn>
+    void for_each(Fn && fn) const
+    {
+        if(!header_) return;
+        for(uint64_t i = 0; i < header_->capacity; ++i)
+        {
+            if(slots_[i].count != 0) fn(static_cast<size_t>(slots_[i].id), slots_[i].count);
+        }
+    }
+
+    // 把 counts 写成索引文件 (次数为 0 的条目跳过)；generation 为已合并进索引的日志代号上界
+    static bool write(const std::filesystem::path & path, const std::unordered_map<size_t, size_t> & counts, uint64_t generation);
+
+private:
+    static constexpr uint32_t magic = 0x584D5150; // "PQMX"
+    static constexpr uint32_t format_version = 1;
+
+    struct header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t generation;
+        uint64_t capacity;
+        uint32_t count;
+        uint32_t max_count;
+    };
+    static_assert(sizeof(header) == 32 && sizeof(slot) == 16);
+
+    // 乘法哈希取高位作为起始槽 (ID 本身已是哈希，这里只为打散低位相近的 ID)
+    static uint64_t home_of(uint64_t id, int shift) { return (id * 0x9E3779B97F4A7C15ull) >> shift; }
+
+    std::unique_ptr<QFile> file_;
+    const header * header_ = nullptr;
+    const slot * slots_ = nullptr;
+    int shift_ = 64;
+};
@@ -0,0 +1,315 @@
+﻿#include "mistake_journal.h"
+#include "platform_utils.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <format>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace
+{
+    // 日志头部: 魔数 + 格式版本；记录为本机字节序的 (uint64 ID, int32 增量)
+    constexpr uint32_t magic = 0x4A4D5150; // "PQMJ"
+    constexpr uint32_t format_version = 1;
+    constexpr qint64 header_size = 8;
+    constexpr qint64 record_size = 12;
+
+    QByteArray header_bytes()
+    {
+        const uint32_t header[2]{ magic, format_version };
+        return QByteArray(reinterpret_cast<const char *>(header), sizeof(header));
+    }
+
+    // 旧版 JSON 快照中记录已合并日志代号的键 (下划线开头，不会与题目 ID 冲突)
+    constexpr QLatin1StringView generation_key("_generation");
+
+    // 读取旧版 mistakes.json (只在迁移时使用)
+    std::unordered_map<size_t, size_t> read_legacy_json(const std::filesystem::path & path, uint64_t & generation)
+    {
+        std::unordered_map<size_t, size_t> counts;
+        generation = 0;
+
+        QFile file(platform_utils::to_q_path(path));
+        if(!file.open(QIODevice::ReadOnly)) return counts;
+
+        QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+        if(!doc.isObject()) return counts;
+
+        const QJsonObject obj = doc.object();
+        counts.reserve(obj.size());
+        for(auto it = obj.begin(); it != obj.end(); ++it)
+        {
+            if(it.key() == generation_key)
+            {
+                generation = static_cast<uint64_t>(it.value().toInteger());
+                continue;
+            }
+            int count = it.value().toInt();
+            if(count > 0) counts[it.key().toULongLong()] = static_cast<size_t>(count);
+        }
+        return counts;
+    }
+
+    std::filesystem::path generation_path(const std::filesystem::path & dir, const std::string & stem, uint64_t generation,
+                                          std::string_view extension)
+    {
+        return dir / std::format("{}.{}.{}", stem, generation, extension);
+    }
+
+    // 把一个日志文件的记录叠加到 counts 上；首次出现的 ID 以 base(id) 为起点 (索引中的次数)
+    // 次数为 0 的条目保留在 counts 中，表示覆盖索引中的值；末尾不完整的记录 (写入时崩溃) 被忽略
+    // 返回完整记录条数，文件不存在或头部不符时返回 std::nullopt
+    template<typename Base>
+    std::optional<size_t> replay(const std::filesystem::path & path, std::unordered_map<size_t, size_t> & counts, Base && base)
+    {
+        QFile file(platform_utils::to_q_path(path));
+        if(!file.open(QIODevice::ReadOnly)) return std::nullopt;
+
+        const QByteArray data = file.readAll();
+        uint32_t header[2]{};
+        if(data.size() < header_size) return std::nullopt;
+        std::memcpy(header, data.constData(), sizeof(header));
+        if(header[0] != magic || header[1] != format_version) return std::nullopt;
+
+        const char * p = data.constData() + header_size;
+        const size_t records = static_cast<size_t>((data.size() - header_size) / record_size);
+        for(size_t i = 0; i < records; ++i, p += record_size)
+        {
+            uint64_t id = 0;
+            int32_t delta = 0;
+            std::memcpy(&id, p, sizeof(id));
+            std::memcpy(&delta, p + sizeof(id), sizeof(delta));
+
+            auto [it, inserted] = counts.try_emplace(static_cast<size_t>(id), 0);
+            if(inserted) it->second = base(it->first);
+            it->second = static_cast<size_t>(std::max<int64_t>(0, static_cast<int64_t>(it->second) + delta));
+        }
+        return records;
+    }
+
+    // 目录下 <stem>.<代号>.<extension> 文件的所有代号 (升序)
+    std::vector<uint64_t> list_generations(const std::filesystem::path & dir, const std::string & stem, std::string_view extension)
+    {
+        std::vector<uint64_t> generations;
+        const QString prefix = QString::fromStdString(stem) + '.';
+        const QString suffix = "." + QString::fromStdString(std::string(extension));
+        const QStringList names = QDir(platform_utils::to_q_path(dir)).entryList({ prefix + '*' + suffix }, QDir::Files);
+        for(const QString & name : names)
+        {
+            const std::string middle = name.mid(prefix.size(), name.size() - prefix.size() - suffix.size()).toStdString();
+            uint64_t generation = 0;
+            auto [end, ec] = std::from_chars(middle.data(), middle.data() + middle.size(), generation);
+            if(ec == std::errc{} && end == middle.data() + middle.size()) generations.push_back(generation);
+        }
+        std::ranges::sort(generations);
+        return generations;
+    }
+}
+
+mistake_journal::mistake_journal(std::filesystem::path legacy_path, io_writer & writer)
+    : dir_(legacy_path.parent_path()), stem_(legacy_path.stem().string()), legacy_path_(std::move(legacy_path)), writer_(writer)
+{
+}
+
+mistake_journal::~mistake_journal()
+{
+    if(compactor_.joinable()) compactor_.join();
+}
+
+std::filesystem::path mistake_journal::journal_path(uint64_t generation) const
+{
+    return generation_path(dir_, stem_, generation, "journal");
+}
+
+std::filesystem::path mistake_journal::index_path(uint64_t generation) const
+{
+    return generation_path(dir_, stem_, generation, "idx");
+}
+
+void mistake_journal::migrate_legacy()
+{
+    if(!QFile::exists(platform_utils::to_q_path(legacy_path_))) return;
+
+    uint64_t generation = 0;
+    const auto counts = read_legacy_json(legacy_path_, generation);
+    if(!mistake_index::write(index_path(generation), counts, generation))
+    {
+        qWarning() << "Failed to migrate" << platform_utils::to_q_path(legacy_path_);
+        return;
+    }
+
+    // 迁移只做一次: 旧文件改名保留，不再读取
+    const QString backup = platform_utils::to_q_path(legacy_path_) + ".bak";
+    QFile::remove(backup);
+    QFile::rename(platform_utils::to_q_path(legacy_path_), backup);
+    qInfo() << "Migrated" << counts.size() << "mistake records to binary index";
+}
+
+std::unordered_map<size_t, size_t> mistake_journal::load()
+{
+    // 索引文件只由压缩线程写入，重新加载前先等它结束
+    if(compactor_.joinable()) compactor_.join();
+    writer_.flush();
+    index_.close();
+
+    auto indexes = list_generations(dir_, stem_, "idx");
+    if(indexes.empty())
+    {
+        migrate_legacy();
+        indexes = list_generations(dir_, stem_, "idx");
+    }
+
+    // 使用代号最大的索引；更旧的是压缩后未能删除的 (例如仍被映射时)
+    // 映射失败的索引不能当作空索引继续 (压缩会用不完整的次数取代它)，改名保留后退回次新的索引
+    uint64_t index_generation = 0;
+    while(!indexes.empty())
+    {
+        const uint64_t generation = indexes.back();
+        indexes.pop_back();
+        if(index_.open(index_path(generation)))
+        {
+            index_generation = generation;
+            break;
+        }
+
+        const QString path = platform_utils::to_q_path(index_path(generation));
+        qWarning() << "Failed to map mistake index, moved aside:" << path;
+        QFile::remove(path + ".corrupt");
+        QFile::rename(path, path + ".corrupt");
+    }
+    for(uint64_t generation : indexes) QFile::remove(platform_utils::to_q_path(index_path(generation)));
+
+    // 损坏的索引留给人工恢复: 期间只追加日志，不合并也不删除
+    compaction_blocked_ = !list_generations(dir_, stem_, "idx.corrupt").empty();
+    if(compaction_blocked_) qWarning() << "Corrupt mistake index present, journal compaction disabled";
+
+    std::unordered_map<size_t, size_t> changed;
+    generation_ = index_generation;
+    records_ = 0;
+
+    for(uint64_t generation : list_generations(dir_, stem_, "journal"))
+    {
+        const auto path = journal_path(generation);
+        if(generation < index_generation)
+        {
+            // 索引已合并但删除前退出留下的旧日志
+            QFile::remove(platform_utils::to_q_path(path));
+            continue;
+        }
+        generation_ = generation;
+        records_ = replay(path, changed, [this](size_t id) { return index_.find(id); }).value_or(0);
+    }
+
+    prepare_current();
+
+    // 上次留下了已封存但未合并的日志
+    if(generation_ > index_generation && !compaction_blocked_) start_compaction();
+
+    return changed;
+}
+
+void mistake_journal::prepare_current()
+{
+    QFile journal(platform_utils::to_q_path(journal_path(generation_)));
+    if(!journal.open(QIODevice::ReadWrite))
+    {
+        qWarning() << "Failed to open mistake journal:" << journal.fileName();
+        return;
+    }
+
+    const qint64 size = journal.size();
+    if(size < header_size)
+    {
+        journal.resize(0);
+        journal.write(header_bytes());
+        records_ = 0;
+        return;
+    }
+
+    qint64 end = header_size + (size - header_size) / record_size * record_size;
+    if(end != size) journal.resize(end);
+}
+
+void mistake_journal::append(size_t id, int32_t delta)
+{
+    QByteArray record(record_size, Qt::Uninitialized);
+    const uint64_t id64 = id;
+    std::memcpy(record.data(), &id64, sizeof(id64));
+    std::memcpy(record.data() + sizeof(id64), &delta, sizeof(delta));
+    writer_.append(journal_path(generation_), std::move(record));
+
+    // 上一次压缩还没结束时继续写当前日志，下次追加再检查
+    if(++records_ >= compact_threshold && !compacting_ && !compaction_blocked_) start_compaction();
+}
+
+void mistake_journal::start_compaction()
+{
+    if(compactor_.joinable()) compactor_.join();
+
+    // 代号小于 upto 的日志都已封存，之后的记录写入新的一代
+    if(records_ > 0)
+    {
+        ++generation_;
+        records_ = 0;
+        writer_.append(journal_path(generation_), header_bytes());
+    }
+    const uint64_t upto = generation_;
+
+    compacting_ = true;
+    compactor_ = std::jthread([this, dir = dir_, stem = stem_, upto]
+        {
+            // 封存的日志可能还有记录在写盘队列里
+            writer_.flush();
+            compact(dir, stem, upto);
+            compacting_ = false;
+        });
+}
+
+void mistake_journal::compact(std::filesystem::path dir, std::string stem, uint64_t upto)
+{
+    // 压缩线程自己映射最新的索引，与 GUI 线程的映射互不影响
+    const auto indexes = list_generations(dir, stem, "idx");
+    const uint64_t from = indexes.empty() ? 0 : indexes.back();
+    if(from >= upto) return;
+
+    std::unordered_map<size_t, size_t> counts;
+    {
+        // 最新的索引打不开时放弃本次压缩: 从空表合并会丢掉索引里的次数，下次加载时再处理
+        mistake_index index;
+        if(!indexes.empty() && !index.open(generation_path(dir, stem, from, "idx")))
+        {
+            qWarning() << "Failed to map mistake index for compaction:" << platform_utils::to_q_path(generation_path(dir, stem, from, "idx"));
+            return;
+        }
+        counts.reserve(index.size());
+        index.for_each([&](size_t id, uint32_t count) { counts.emplace(id, count); });
+    }
+
+    std::vector<uint64_t> merged;
+    for(uint64_t generation : list_generations(dir, stem, "journal"))
+    {
+        if(generation < from || generation >= upto) continue;
+        replay(generation_path(dir, stem, generation, "journal"), counts, [](size_t) { return size_t{ 0 }; });
+        merged.push_back(generation);
+    }
+
+    const auto path = generation_path(dir, stem, upto, "idx");
+    if(!mistake_index::write(path, counts, upto))
+    {
+        qWarning() << "Failed to compact mistake journal into" << platform_utils::to_q_path(path);
+        return;
+    }
+
+    // 新索引已写好，合并过的日志和旧索引可以删除；删除失败 (旧索引仍被映射) 时下次加载再清理
+    for(uint64_t generation : merged) QFile::remove(platform_utils::to_q_path(generation_path(dir, stem, generation, "journal")));
+    for(uint64_t generation : indexes) QFile::remove(platform_utils::to_q_path(generation_path(dir, stem, generation, "idx")));
+}
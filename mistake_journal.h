@@ -0,0 +1,69 @@
+﻿#pragma once
+
+#include "mistake_index.h"
+#include "io_writer.h"
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include <QByteArray>
+
+// 错题记录的追加式日志: 每次答错只在日志末尾追加一条 (ID, 增量) 记录，不再重写整个 mistakes.json
+// 磁盘上是一个二进制索引 (mistakes.<代号>.idx，见 mistake_index) 加若干代日志 (mistakes.<代号>.journal)
+// 索引的代号表示代号更小的日志都已合并进去；当前日志超过阈值时封存并开启新的一代，
+// 后台线程把封存的日志合并成新一代的索引后删除旧文件 (索引按代号命名，不覆盖正在映射的文件)
+// 日志的写入交给 io_writer 在写盘线程中完成，读取日志 (加载、压缩) 前先 flush
+class mistake_journal
+{
+public:
+    // legacy_path: 旧版 mistakes.json，索引和日志放在同一目录下并沿用它的文件名主干
+    // writer 必须比日志对象活得更久
+    mistake_journal(std::filesystem::path legacy_path, io_writer & writer);
+    ~mistake_journal(); // 等待后台压缩结束
+
+    mistake_journal(const mistake_journal &) = delete;
+    mistake_journal & operator=(const mistake_journal &) = delete;
+
+    // 映射最新的索引 (没有索引时先从旧版 JSON 迁移)，再按代号顺序重放日志；随后打开当前一代日志用于追加
+    // 返回日志中出现过的题目的错误次数 (已叠加索引中的值，可能为 0)，其余题目查 index()
+    // 上次退出前未完成的压缩会在这里重新开始
+    // 无法映射的索引改名为 <文件名>.corrupt 保留并退回次新的索引；目录下有 .corrupt 文件时不再压缩，以免删除仍可恢复的数据
+    std::unordered_map<size_t, size_t> load();
+
+    // load 时映射的索引，之后的变化只在日志和 load 返回的表里
+    const mistake_index & index() const { return index_; }
+
+    // 追加一条记录 (固定 12 字节，由写盘线程写入)
+    void append(size_t id, int32_t delta);
+
+private:
+    // 当前日志达到这么多条记录后封存并在后台压缩 (约 48 KiB)
+    static constexpr size_t compact_threshold = 4096;
+
+    std::filesystem::path journal_path(uint64_t generation) const;
+    std::filesystem::path index_path(uint64_t generation) const;
+
+    void migrate_legacy();
+
+    // 加载时检查当前一代日志: 截掉末尾不完整的记录，新文件写入头部
+    void prepare_current();
+
+    // 封存当前日志，在后台把 [索引代号, upto) 之间的日志合并成代号为 upto 的索引
+    void start_compaction();
+    static void compact(std::filesystem::path dir, std::string stem, uint64_t upto);
+
+    std::filesystem::path dir_;
+    std::string stem_;
+    std::filesystem::path legacy_path_;
+    mistake_index index_;
+    io_writer & writer_;
+    uint64_t generation_ = 0;       // 当前追加的日志代号
+    size_t records_ = 0;            // 当前日志中的记录数
+
+    bool compaction_blocked_ = false; // 有损坏的索引: 只追加日志，不压缩
+    std::atomic<bool> compacting_{ false };
+    std::jthread compactor_;        // 最后声明: 析构时最先 join
+};
@@ -10,21 +10,40 @@ HistoryPage::HistoryPage(QWidget *parent)
     // 初始化表头
     ui.tableHistory->setColumnCount(4);
     ui.tableHistory->setHorizontalHeaderLabels({ "时间", "得分", "正确率", "耗时" });
+
+    // 分页加载按钮放在表格下方
+    btnLoadMore_ = new QPushButton("加载更多", this);
+    btnLoadMore_->hide();
+    ui.verticalLayout_History->addWidget(btnLoadMore_);
+    connect(btnLoadMore_, &QPushButton::clicked, this, &HistoryPage::loadMoreClicked);
 }
 
 void HistoryPage::clearHistory()
 {
     ui.tableHistory->setRowCount(0);
+    btnLoadMore_->hide();
+}
+
+void HistoryPage::setHasMore(bool hasMore)
+{
+    btnLoadMore_->setVisible(hasMore);
 }
 
 void HistoryPage::loadHistory(const std::vector<exam_record>& records)
 {
     ui.tableHistory->setRowCount(0);
-    ui.tableHistory->setRowCount(static_cast<int>(records.size()));
+    appendHistory(records);
+}
+
+void HistoryPage::appendHistory(const std::vector<exam_record>& records)
+{
+    const int first = ui.tableHistory->rowCount();
+    ui.tableHistory->setRowCount(first + static_cast<int>(records.size()));
 
-    for(size_t i = 0; i < records.size(); ++i)
+    for(size_t k = 0; k < records.size(); ++k)
     {
-        const auto & r = records[i];
+        const auto & r = records[k];
+        const int i = first + static_cast<int>(k);
         
         // 时间
         ui.tableHistory->setItem(i, 0, new QTableWidgetItem(QString::fromStdString(r.date)));
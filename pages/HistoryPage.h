@@ -16,12 +16,18 @@ public:
     // 加载历史记录到表格
     void loadHistory(const std::vector<exam_record>& records);
 
+    // 分页: 追加下一页记录到表格末尾；hasMore 控制 "加载更多" 按钮是否显示
+    void appendHistory(const std::vector<exam_record>& records);
+    void setHasMore(bool hasMore);
+
     // 清空表格
     void clearHistory();
 
 signals:
     void backClicked();
+    void loadMoreClicked();
 
 private:
     Ui::HistoryPage ui;
+    QPushButton * btnLoadMore_ = nullptr;
 };
@@ -4,6 +4,8 @@
 #include <QScroller>
 #include <QMessageBox>
 #include <QPushButton>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
 
 HomePage::HomePage(QWidget *parent)
     : QWidget(parent)
@@ -45,6 +47,29 @@ HomePage::HomePage(QWidget *parent)
         }
     });
 
+    // 加载进度区域 (放在考试区域下方)
+    loadPanel_ = new QWidget(this);
+    QVBoxLayout* loadLayout = new QVBoxLayout(loadPanel_);
+    loadLayout->setContentsMargins(0, 0, 0, 0);
+
+    loadLabel_ = new QLabel(loadPanel_);
+    loadLayout->addWidget(loadLabel_);
+
+    QHBoxLayout* barLayout = new QHBoxLayout();
+    loadProgress_ = new QProgressBar(loadPanel_);
+    loadProgress_->setRange(0, 1000);
+    loadProgress_->setTextVisible(false);
+    barLayout->addWidget(loadProgress_, 1);
+
+    QPushButton* btnCancelLoad = new QPushButton("取消", loadPanel_);
+    barLayout->addWidget(btnCancelLoad);
+    loadLayout->addLayout(barLayout);
+
+    ui.verticalLayout_HomeContent->insertWidget(ui.verticalLayout_HomeContent->indexOf(ui.groupBox_Exam) + 1, loadPanel_);
+    loadPanel_->hide();
+
+    connect(btnCancelLoad, &QPushButton::clicked, this, &HomePage::cancelLoading);
+
     // 关于按钮
     QPushButton* btnAbout = new QPushButton("关于", this);
     btnAbout->setFlat(true);
@@ -57,3 +82,33 @@ HomePage::HomePage(QWidget *parent)
             "<p>GitHub: <a href='https://github.com/Iviesever/Helper-02'>https://github.com/Iviesever/Helper-02</a></p>");
     });
 }
+
+void HomePage::setLoading(bool loading)
+{
+    loadPanel_->setVisible(loading);
+    if(loading) {
+        loadProgress_->setValue(0);
+        loadLabel_->setText("正在加载题库...");
+    }
+
+    // 加载期间禁止再次触发加载
+    const QList<QWidget*> triggers = { ui.btnStartSeq, ui.btnStartRand, ui.btnViewMode, ui.btnToExamConfig,
+                                       ui.btnPracticeStrategy, ui.comboRepo, ui.listWidgetFiles };
+    for(QWidget* w : triggers) {
+        w->setEnabled(!loading);
+    }
+}
+
+void HomePage::setLoadProgress(int filesDone, int filesTotal, qint64 bytesDone, qint64 bytesTotal)
+{
+    // 多个工作线程的进度可能乱序到达，只前进不后退
+    int value = bytesTotal > 0 ? static_cast<int>(bytesDone * 1000 / bytesTotal) : 0;
+    if(value < loadProgress_->value()) return;
+
+    loadProgress_->setValue(value);
+    loadLabel_->setText(QString("正在加载 %1/%2 个文件 (%3 / %4 MB)")
+        .arg(filesDone)
+        .arg(filesTotal)
+        .arg(bytesDone / (1024.0 * 1024.0), 0, 'f', 1)
+        .arg(bytesTotal / (1024.0 * 1024.0), 0, 'f', 1));
+}
@@ -5,6 +5,8 @@
 #include <QComboBox>
 #include <QListWidget>
 #include <QScrollArea>
+#include <QProgressBar>
+#include <QLabel>
 #include "ui_HomePage.h"
 
 class HomePage : public QWidget
@@ -41,6 +43,10 @@ public:
         return paths;
     }
     
+    // 加载状态: 显示进度条和取消按钮，并禁用会触发加载的按钮
+    void setLoading(bool loading);
+    void setLoadProgress(int filesDone, int filesTotal, qint64 bytesDone, qint64 bytesTotal);
+
     // 更新错题次数下拉框
     void updateMistakeCountCombo(size_t maxCount)
     {
@@ -66,6 +72,13 @@ signals:
     // 题库切换信号
     void repoChanged(int index);
 
+    // 取消正在进行的加载
+    void cancelLoading();
+
 private:
     Ui::HomePage ui;
+
+    QWidget* loadPanel_ = nullptr;       // 加载进度区域 (代码创建，默认隐藏)
+    QProgressBar* loadProgress_ = nullptr;
+    QLabel* loadLabel_ = nullptr;
 };
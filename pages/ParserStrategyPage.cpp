@@ -1,6 +1,7 @@
 ﻿#include "ParserStrategyPage.h"
 #include "../storage_manager.h"
 #include "../parser/text_parser.h"
+#include "../bank_loader.h"
 #include <QMessageBox>
 #include <QFileDialog>
 #include <QDialog>
@@ -183,30 +184,28 @@ void ParserStrategyPage::onTestClicked()
     parser_strategy strategy = getStrategyFromUI();
     text_parser parser(strategy);
 
-    std::vector<question> questions;
-    QFile file(filePath);
-    if (file.open(QIODevice::ReadOnly | QIODevice::Text))
+    // 只读扫描即可，不生成题目
+    question_view_list loaded;
+    if (!bank_loader::view_file(filePath.toStdString(), parser, loaded))
     {
-         QTextStream in(&file);
-         in.setEncoding(QStringConverter::Utf8);
-         QString content = in.readAll();
-         std::string std_content = content.toStdString();
-         
-         std::string path_str = filePath.toStdString();
-         size_t last_slash = path_str.find_last_of("/\\");
-         std::string simple_filename = (last_slash != std::string::npos) ? path_str.substr(last_slash + 1) : path_str;
-
-         questions = parser.parse(std_content, simple_filename);
-         file.close();
-    }
-    else
-    {
-         QMessageBox::critical(this, "错误", "无法打开测试文件！");
+         QMessageBox::critical(this, "错误", "无法读取测试文件 (文件无法打开或编码无法识别)！");
          return;
     }
+    const std::vector<question_view>& questions = loaded.views();
 
     // 构建结果文本
     QString result = QString("解析结果：共 %1 题\n\n").arg(questions.size());
+
+    // 提示退回 std::regex 的垃圾行正则 (不影响结果，只影响速度)
+    if (!parser.unsupported_patterns().empty())
+    {
+        result += "注意：以下过滤正则使用了快速匹配不支持的语法，已退回标准正则 (大文件解析较慢)：\n";
+        for (const auto& pattern : parser.unsupported_patterns())
+        {
+            result += "  " + QString::fromStdString(pattern) + "\n";
+        }
+        result += "\n";
+    }
     
     for (size_t i = 0; i < questions.size(); ++i)
     {
@@ -221,7 +220,7 @@ void ParserStrategyPage::onTestClicked()
             default: typeStr = "未知"; break;
         }
         
-        QString contentPreview = QString::fromStdString(q.content);
+        QString contentPreview = QString::fromUtf8(q.content.data(), q.content.size()).remove('\r');
         if (contentPreview.length() > 80)
             contentPreview = contentPreview.left(80) + "...";
         
@@ -229,7 +228,7 @@ void ParserStrategyPage::onTestClicked()
             .arg(i + 1)
             .arg(typeStr)
             .arg(contentPreview)
-            .arg(QString::fromStdString(q.correct_answer));
+            .arg(QString::fromUtf8(q.correct_answer.data(), q.correct_answer.size()));
     }
 
     // 创建可滚动对话框
@@ -314,7 +313,9 @@ void ParserStrategyPage::setupReferenceSection()
     if(t.empty()) return true;
 
     // 1. Regex check (for patterns like "^\s*\d+分\s*$")
-    for(const auto & re : re_garbage_list_)
+    //    所有正则合并成一个 DFA，整行只扫描一遍
+    if(garbage_dfa_.match(t)) return true;
+    for(const auto & re : re_garbage_list_)   // DFA 不支持的语法
         if(std::regex_match(t.begin(), t.end(), re)) return true;
 
     // 2. Plain text check (e.g., "AI讲解", "查看作答记录")
@@ -327,9 +328,10 @@ void ParserStrategyPage::setupReferenceSection()
         "确定题目类型。优先检查【单选/多选/判断/填空关键词】，如果未匹配则根据选项特征自动推断。",
         R"(question_type text_parser::detect_type(std::string_view block, std::string_view answer_raw) const
 {
-    // 优先：关键词检测
-    if (contains_keyword(block, strategy_.multi_keywords)) return question_type::multi;
-    if (contains_keyword(block, strategy_.judge_keywords)) return question_type::judge;
+    // 优先：关键词检测 (所有关键词编译成一个自动机，只扫描一遍)
+    uint32_t hit = keywords_.scan(block, kw_type_mask);
+    if (hit & kw_multi) return question_type::multi;
+    if (hit & kw_judge) return question_type::judge;
     // ...
 
     // 推断：根据选项特征 (支持全角/半角点号)
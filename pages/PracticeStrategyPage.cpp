@@ -28,39 +28,13 @@ PracticeStrategyPage::PracticeStrategyPage(QWidget *parent)
     connect(ui.chkSkipJudgeB, &QCheckBox::toggled, this, &PracticeStrategyPage::settingsChanged);
 }
 
-void PracticeStrategyPage::loadStatistics(const std::vector<question>& questions)
+void PracticeStrategyPage::loadStatistics(const bank_index::summary& stats)
 {
-    // 统计各类型数量
-    int singleCount = 0, multiCount = 0, judgeCount = 0, fillCount = 0;
-    
-    // 清空并重新统计答案分布
-    singleAnswerDist_.clear();
-    judgeAnswerDist_.clear();
-    
-    for (const auto& q : questions)
-    {
-        switch (q.type)
-        {
-        case question_type::single:
-            singleCount++;
-            if (!q.correct_answer.empty())
-                singleAnswerDist_[q.correct_answer]++;
-            break;
-        case question_type::multi:
-            multiCount++;
-            break;
-        case question_type::judge:
-            judgeCount++;
-            if (!q.correct_answer.empty())
-                judgeAnswerDist_[q.correct_answer]++;
-            break;
-        case question_type::fill:
-            fillCount++;
-            break;
-        default:
-            break;
-        }
-    }
+    // 各类型数量
+    int singleCount = static_cast<int>(stats.count(question_type::single));
+    int multiCount = static_cast<int>(stats.count(question_type::multi));
+    int judgeCount = static_cast<int>(stats.count(question_type::judge));
+    int fillCount = static_cast<int>(stats.count(question_type::fill));
     
     int total = singleCount + multiCount + judgeCount + fillCount;
     
@@ -72,24 +46,17 @@ void PracticeStrategyPage::loadStatistics(const std::vector<question>& questions
     ui.label_TotalCount->setText(QString("总计: %1 题").arg(total));
     
     // 显示单选题各选项分布
-    auto getCount = [](const std::unordered_map<std::string, int>& map, const std::string& key) {
-        auto it = map.find(key);
-        return it != map.end() ? it->second : 0;
-    };
-    
-    int countA = getCount(singleAnswerDist_, "A");
-    int countB = getCount(singleAnswerDist_, "B");
-    int countC = getCount(singleAnswerDist_, "C");
-    int countD = getCount(singleAnswerDist_, "D");
+    int countA = static_cast<int>(stats.single_answers[0]);
+    int countB = static_cast<int>(stats.single_answers[1]);
+    int countC = static_cast<int>(stats.single_answers[2]);
+    int countD = static_cast<int>(stats.single_answers[3]);
     
     // 找出最常见单选答案（可能有多个）
     int maxSingle = std::max({countA, countB, countC, countD});
-    mostCommonSingle_.clear();
+    mostCommonSingle_ = 0;
     if (maxSingle > 0) {
-        if (countA == maxSingle) mostCommonSingle_ += "A";
-        if (countB == maxSingle) mostCommonSingle_ += "B";
-        if (countC == maxSingle) mostCommonSingle_ += "C";
-        if (countD == maxSingle) mostCommonSingle_ += "D";
+        for (int i = 0; i < 4; ++i)
+            if (static_cast<int>(stats.single_answers[i]) == maxSingle) mostCommonSingle_ |= 1u << i;
     }
     
     auto formatDist = [singleCount, maxSingle](const QString& opt, int count) {
@@ -104,22 +71,22 @@ void PracticeStrategyPage::loadStatistics(const std::vector<question>& questions
     ui.label_SingleDistD->setText(formatDist("D", countD));
     
     // 更新单选最常见答案跳过按钮
-    if (!mostCommonSingle_.isEmpty()) {
-        ui.chkSkipSingleMostCommon->setText(QString("跳过最常见答案 (%1)").arg(mostCommonSingle_));
+    if (mostCommonSingle_ != 0) {
+        ui.chkSkipSingleMostCommon->setText(QString("跳过最常见答案 (%1)").arg(mostCommonSingleAnswer()));
     } else {
         ui.chkSkipSingleMostCommon->setText("跳过最常见答案 (无数据)");
     }
     
     // 显示判断题各选项分布
-    int judgeA = getCount(judgeAnswerDist_, "A");
-    int judgeB = getCount(judgeAnswerDist_, "B");
+    int judgeA = static_cast<int>(stats.judge_answers[0]);
+    int judgeB = static_cast<int>(stats.judge_answers[1]);
     
     // 找出最常见判断答案（可能有多个）
     int maxJudge = std::max(judgeA, judgeB);
-    mostCommonJudge_.clear();
+    mostCommonJudge_ = 0;
     if (maxJudge > 0) {
-        if (judgeA == maxJudge) mostCommonJudge_ += "A";
-        if (judgeB == maxJudge) mostCommonJudge_ += "B";
+        if (judgeA == maxJudge) mostCommonJudge_ |= option_bit('A');
+        if (judgeB == maxJudge) mostCommonJudge_ |= option_bit('B');
     }
     
     auto formatJudge = [judgeCount, maxJudge](const QString& opt, int count) {
@@ -132,8 +99,8 @@ void PracticeStrategyPage::loadStatistics(const std::vector<question>& questions
     ui.label_JudgeDistB->setText(formatJudge("B(错)", judgeB));
     
     // 更新判断最常见答案跳过按钮
-    if (!mostCommonJudge_.isEmpty()) {
-        QString display = mostCommonJudge_;
+    if (mostCommonJudge_ != 0) {
+        QString display = mostCommonJudgeAnswer();
         if (display == "A") display = "A/对";
         else if (display == "B") display = "B/错";
         else if (display == "AB") display = "AB/都常见";
@@ -162,10 +129,8 @@ void PracticeStrategyPage::clearStatistics()
     ui.chkSkipSingleMostCommon->setText("跳过最常见答案 (无数据)");
     ui.chkSkipJudgeMostCommon->setText("跳过最常见答案 (无数据)");
     
-    mostCommonSingle_.clear();
-    mostCommonJudge_.clear();
-    singleAnswerDist_.clear();
-    judgeAnswerDist_.clear();
+    mostCommonSingle_ = 0;
+    mostCommonJudge_ = 0;
 }
 
 void PracticeStrategyPage::loadStrategy(const practice_strategy& strategy)
@@ -221,36 +186,6 @@ std::array<bool, 2> PracticeStrategyPage::skipJudgeOptions() const
     };
 }
 
-bool PracticeStrategyPage::shouldSkipSingle(const QString& answer) const
-{
-    // 最常见答案跳过优先（可能有多个，如AB）
-    if (ui.chkSkipSingleMostCommon->isChecked() && !mostCommonSingle_.isEmpty()) {
-        if (mostCommonSingle_.contains(answer)) return true;
-    }
-    
-    // 单独选项跳过
-    if (answer == "A" && ui.chkSkipSingleA->isChecked()) return true;
-    if (answer == "B" && ui.chkSkipSingleB->isChecked()) return true;
-    if (answer == "C" && ui.chkSkipSingleC->isChecked()) return true;
-    if (answer == "D" && ui.chkSkipSingleD->isChecked()) return true;
-    
-    return false;
-}
-
-bool PracticeStrategyPage::shouldSkipJudge(const QString& answer) const
-{
-    // 最常见答案跳过优先（可能有多个，如AB都常见）
-    if (ui.chkSkipJudgeMostCommon->isChecked() && !mostCommonJudge_.isEmpty()) {
-        if (mostCommonJudge_.contains(answer)) return true;
-    }
-    
-    // 单独选项跳过
-    if (answer == "A" && ui.chkSkipJudgeA->isChecked()) return true;
-    if (answer == "B" && ui.chkSkipJudgeB->isChecked()) return true;
-    
-    return false;
-}
-
 void PracticeStrategyPage::setRepoName(const QString& name)
 {
     ui.label_Title->setText(name + " 刷题策略");
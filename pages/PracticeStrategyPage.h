@@ -3,9 +3,9 @@
 #include <QWidget>
 #include <vector>
 #include <array>
-#include <unordered_map>
 #include "ui_PracticeStrategyPage.h"
 #include "../question.h"
+#include "../bank_index.h"
 
 class PracticeStrategyPage : public QWidget
 {
@@ -15,8 +15,8 @@ public:
     explicit PracticeStrategyPage(QWidget *parent = nullptr);
     ~PracticeStrategyPage() = default;
 
-    // 加载题库统计信息
-    void loadStatistics(const std::vector<question>& questions);
+    // 加载题库统计信息 (由列式索引一次扫描得到)
+    void loadStatistics(const bank_index::summary& stats);
     
     // 设置题库名称（用于动态标题）
     void setRepoName(const QString& name);
@@ -39,12 +39,10 @@ public:
     std::array<bool, 2> skipJudgeOptions() const;
     
     // 获取最常见答案用于过滤
-    QString mostCommonSingleAnswer() const { return mostCommonSingle_; }
-    QString mostCommonJudgeAnswer() const { return mostCommonJudge_; }
-    
-    // 检查是否应跳过单选题（考虑优先级）
-    bool shouldSkipSingle(const QString& answer) const;
-    bool shouldSkipJudge(const QString& answer) const;
+    QString mostCommonSingleAnswer() const { return QString::fromStdString(answer_letters(mostCommonSingle_)); }
+    QString mostCommonJudgeAnswer() const { return QString::fromStdString(answer_letters(mostCommonJudge_)); }
+    uint32_t mostCommonSingleMask() const { return mostCommonSingle_; }
+    uint32_t mostCommonJudgeMask() const { return mostCommonJudge_; }
 
 signals:
     void backClicked();
@@ -53,11 +51,8 @@ signals:
 private:
     Ui::PracticeStrategyPage ui;
     
-    // 最常见答案
-    QString mostCommonSingle_;
-    QString mostCommonJudge_;
-    
-    // 答案分布统计
-    std::unordered_map<std::string, int> singleAnswerDist_;
-    std::unordered_map<std::string, int> judgeAnswerDist_;
+    // 最常见答案 (位掩码，可能有多个并列)
+    uint32_t mostCommonSingle_ = 0;
+    uint32_t mostCommonJudge_ = 0;
+
 };
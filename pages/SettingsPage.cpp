@@ -4,6 +4,7 @@
 #include <QScrollBar>
 #include <QScroller>
 #include <QFileDialog>
+#include <QPushButton>
 
 SettingsPage::SettingsPage(QWidget *parent)
     : QWidget(parent)
@@ -23,6 +24,15 @@ SettingsPage::SettingsPage(QWidget *parent)
     connect(ui.btnSave, &QPushButton::clicked, this, &SettingsPage::saveClicked);
     connect(ui.btnBrowseRepo, &QAbstractButton::clicked, this, &SettingsPage::browseRepoClicked);
     connect(ui.btnBrowseData, &QAbstractButton::clicked, this, &SettingsPage::browseDataClicked);
+
+    // 导出错题记录和考试历史 (都以二进制格式保存，这里导出为 JSON)，放在保存按钮上方
+    auto * btnExportMistakes = new QPushButton("导出错题记录", ui.scrollContent_Settings);
+    ui.verticalLayout_SettContent->insertWidget(ui.verticalLayout_SettContent->indexOf(ui.btnSave), btnExportMistakes);
+    connect(btnExportMistakes, &QPushButton::clicked, this, &SettingsPage::exportMistakesClicked);
+
+    auto * btnExportHistory = new QPushButton("导出考试历史", ui.scrollContent_Settings);
+    ui.verticalLayout_SettContent->insertWidget(ui.verticalLayout_SettContent->indexOf(ui.btnSave), btnExportHistory);
+    connect(btnExportHistory, &QPushButton::clicked, this, &SettingsPage::exportHistoryClicked);
     
     // 滑块预览
     connect(ui.sliderFontTitle, &QSlider::valueChanged, this, [this](int value) {
@@ -36,6 +36,8 @@ signals:
     void saveClicked();
     void browseRepoClicked();
     void browseDataClicked();
+    void exportMistakesClicked();
+    void exportHistoryClicked();
 
 private:
     Ui::SettingsPage ui;
@@ -0,0 +1,171 @@
+﻿#include "parse_cache.h"
+#include "platform_utils.h"
+
+#include <algorithm>
+#include <format>
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+namespace
+{
+    void write_string(QDataStream & out, std::string_view s)
+    {
+        out << static_cast<quint32>(s.size());
+        out.writeRawData(s.data(), static_cast<int>(s.size()));
+    }
+
+    template<typename String>
+    bool read_string(QDataStream & in, String & s)
+    {
+        quint32 size = 0;
+        in >> size;
+        // 长度超过剩余数据说明文件已损坏
+        if(in.status() != QDataStream::Ok || size > in.device()->bytesAvailable()) return false;
+
+        s.resize(size);
+        return in.readRawData(s.data(), static_cast<int>(size)) == static_cast<int>(size);
+    }
+
+    // 读取条目头部: 源文件路径和缓存键
+    bool read_header(QDataStream & in, uint32_t magic, uint32_t version, std::string & path, parse_cache::file_key & key)
+    {
+        quint32 file_magic = 0, file_version = 0;
+        in >> file_magic >> file_version;
+        if(file_magic != magic || file_version != version) return false;
+        if(!read_string(in, path)) return false;
+
+        qint64 size = 0, mtime = 0;
+        quint64 content_hash = 0, strategy_hash = 0;
+        in >> size >> mtime >> content_hash >> strategy_hash;
+        key = { size, mtime, static_cast<size_t>(content_hash), static_cast<size_t>(strategy_hash) };
+        return in.status() == QDataStream::Ok;
+    }
+}
+
+std::filesystem::path parse_cache::entry_path(const std::string & path, size_t strategy_hash) const
+{
+    return dir_ / std::format("{:016x}-{:016x}.bin", stable_hash(path), static_cast<uint64_t>(strategy_hash));
+}
+
+std::optional<std::vector<question>> parse_cache::load(const std::string & path, const file_key & key, uint32_t file_id,
+                                                       std::pmr::memory_resource * resource) const
+{
+    QFile file(platform_utils::to_q_path(entry_path(path, key.strategy_hash)));
+    if(!file.open(QIODevice::ReadOnly)) return std::nullopt;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    std::string cached_path;
+    file_key cached_key;
+    // 路径也要比较: 不同路径的哈希可能碰撞
+    if(!read_header(in, magic, format_version, cached_path, cached_key) || cached_path != path || cached_key != key)
+    {
+        return std::nullopt;
+    }
+
+    quint32 count = 0;
+    in >> count;
+
+    std::vector<question> questions;
+    questions.reserve(std::min<quint32>(count, 1u << 20));
+    std::string option_buffer;   // 选项缓冲区先读到这里，校验偏移表后再复制到内存区
+    for(quint32 i = 0; i < count; ++i)
+    {
+        question & q = questions.emplace_back(resource);
+        quint8 type = 0;
+        quint64 id = 0;
+        quint64 block_offset = 0;
+        quint32 answer_mask = 0;
+        quint32 option_count = 0;
+        in >> type >> id >> block_offset >> answer_mask;
+
+        if(!read_string(in, q.content) || !read_string(in, q.correct_answer)) return std::nullopt;
+        in >> option_count;
+        if(in.status() != QDataStream::Ok || type > static_cast<quint8>(question_type::unknown)) return std::nullopt;
+
+        // 选项按 option_list 的扁平缓冲区原样保存
+        if(!read_string(in, option_buffer) || !q.options.assign_buffer(option_count, option_buffer)) return std::nullopt;
+
+        q.type = static_cast<question_type>(type);
+        q.id = static_cast<size_t>(id);
+        q.file_id = file_id;
+        q.block_offset = block_offset;
+        q.answer_mask = answer_mask;
+    }
+
+    if(in.status() != QDataStream::Ok) return std::nullopt;
+    return questions;
+}
+
+void parse_cache::store(const std::string & path, const file_key & key, const std::vector<question> & questions) const
+{
+    QDir().mkpath(platform_utils::to_q_path(dir_));
+
+    // QSaveFile 先写临时文件再替换，中途失败不会留下半截的缓存
+    QSaveFile file(platform_utils::to_q_path(entry_path(path, key.strategy_hash)));
+    if(!file.open(QIODevice::WriteOnly)) return;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+
+    out << static_cast<quint32>(magic) << static_cast<quint32>(format_version);
+    write_string(out, path);
+    out << static_cast<qint64>(key.size) << static_cast<qint64>(key.mtime)
+        << static_cast<quint64>(key.content_hash) << static_cast<quint64>(key.strategy_hash);
+
+    // 来源文件由题库的文件表记录，不写入缓存
+    out << static_cast<quint32>(questions.size());
+
+    for(const auto & q : questions)
+    {
+        out << static_cast<quint8>(q.type) << static_cast<quint64>(q.id) << static_cast<quint64>(q.block_offset)
+            << static_cast<quint32>(q.answer_mask);
+        write_string(out, q.content);
+        write_string(out, q.correct_answer);
+        out << static_cast<quint32>(q.options.size());
+        write_string(out, q.options.buffer());
+    }
+
+    if(out.status() == QDataStream::Ok) file.commit();
+}
+
+void parse_cache::evict_stale(const std::unordered_set<size_t> & live_strategies, std::stop_token stop) const
+{
+    QDir dir(platform_utils::to_q_path(dir_));
+    if(!dir.exists()) return;
+
+    for(const QFileInfo & entry : dir.entryInfoList({ "*.bin" }, QDir::Files))
+    {
+        if(stop.stop_requested()) return;
+
+        bool stale = true;
+
+        QFile file(entry.absoluteFilePath());
+        if(file.open(QIODevice::ReadOnly))
+        {
+            QDataStream in(&file);
+            in.setVersion(QDataStream::Qt_6_0);
+
+            std::string path;
+            file_key key;
+            if(read_header(in, magic, format_version, path, key))
+            {
+                // 只比较大小和修改时间；内容哈希留到加载时再核对
+                // 策略改过或删掉后，旧哈希的条目再也不会命中，不清理的话目录会随着调整策略一直变大
+                QFileInfo source(QString::fromStdString(path));
+                stale = !live_strategies.contains(key.strategy_hash)
+                    || !source.exists()
+                    || source.size() != key.size
+                    || source.lastModified().toMSecsSinceEpoch() != key.mtime;
+            }
+            file.close();
+        }
+
+        if(stale) QFile::remove(entry.absoluteFilePath());
+    }
+}
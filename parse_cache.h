@@ -0,0 +1,51 @@
+﻿#pragma once
+
+#include "question.h"
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// 题库解析缓存: 每个 txt 文件的解析结果以紧凑的二进制格式保存在数据目录下
+// 命中时直接反序列化，完全跳过 text_parser
+class parse_cache
+{
+public:
+    // 缓存键: 源文件大小、修改时间、内容哈希和解析策略哈希，任一变化都视为失效
+    struct file_key
+    {
+        int64_t size = 0;
+        int64_t mtime = 0;          // 修改时间 (毫秒)
+        size_t content_hash = 0;
+        size_t strategy_hash = 0;
+
+        bool operator==(const file_key &) const = default;
+    };
+
+    explicit parse_cache(std::filesystem::path dir) : dir_(std::move(dir)) {}
+
+    // 查找缓存；未命中或缓存文件损坏时返回 std::nullopt
+    // 题目字符串分配在 resource 中，file_id 写入每道题 (缓存本身不保存来源文件)
+    std::optional<std::vector<question>> load(const std::string & path, const file_key & key, uint32_t file_id = 0,
+                                              std::pmr::memory_resource * resource = std::pmr::get_default_resource()) const;
+
+    // 写入缓存 (同一源文件在同一解析策略下只保留一个条目，旧条目被覆盖；不同策略的条目互不影响)
+    void store(const std::string & path, const file_key & key, const std::vector<question> & questions) const;
+
+    // 删除源文件已不存在或已被修改的条目，以及解析策略已不在 live_strategies 中 (策略被修改或删除) 的条目
+    // stop 被请求后提前返回
+    void evict_stale(const std::unordered_set<size_t> & live_strategies, std::stop_token stop = {}) const;
+
+private:
+    // 解析逻辑或序列化格式变化时递增，使旧缓存全部失效
+    static constexpr uint32_t format_version = 5;
+    static constexpr uint32_t magic = 0x43504251; // "QBPC"
+
+    // 条目文件名由源文件路径和解析策略共同决定，切换策略不会覆盖另一策略的缓存
+    std::filesystem::path entry_path(const std::string & path, size_t strategy_hash) const;
+
+    std::filesystem::path dir_;
+};
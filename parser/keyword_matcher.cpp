@@ -0,0 +1,86 @@
+﻿#include "keyword_matcher.h"
+#include <queue>
+
+void keyword_matcher::add(std::string_view keyword, uint32_t classes)
+{
+    if (keyword.empty()) {
+        always_ |= classes;
+        return;
+    }
+    patterns_.push_back({ std::string(keyword), classes });
+}
+
+void keyword_matcher::build()
+{
+    // 1. 压缩字母表: 只有在关键词中出现过的字节才需要单独的列
+    byte_class_.fill(0);
+    alphabet_size_ = 1;
+    for (const auto& p : patterns_) {
+        for (unsigned char c : p.text) {
+            if (byte_class_[c] == 0) byte_class_[c] = static_cast<uint8_t>(alphabet_size_++);
+        }
+    }
+
+    // 2. 构建 Trie (-1 表示尚无转移)
+    delta_.assign(alphabet_size_, -1);
+    output_.assign(1, 0);
+    for (const auto& p : patterns_) {
+        int32_t state = 0;
+        for (unsigned char c : p.text) {
+            size_t slot = state * alphabet_size_ + byte_class_[c];
+            if (delta_[slot] < 0) {
+                delta_[slot] = static_cast<int32_t>(output_.size());
+                delta_.resize(delta_.size() + alphabet_size_, -1);
+                output_.push_back(0);
+            }
+            state = delta_[slot];
+        }
+        output_[state] |= p.classes;
+    }
+
+    // 3. BFS 计算失败链接，并把缺失的转移补全为完整 DFA
+    std::vector<int32_t> fail(output_.size(), 0);
+    std::queue<int32_t> pending;
+    for (size_t cls = 0; cls < alphabet_size_; ++cls) {
+        int32_t& next = delta_[cls];
+        if (next < 0) {
+            next = 0;
+        } else {
+            fail[next] = 0;
+            pending.push(next);
+        }
+    }
+
+    while (!pending.empty()) {
+        int32_t state = pending.front();
+        pending.pop();
+        output_[state] |= output_[fail[state]];
+
+        for (size_t cls = 0; cls < alphabet_size_; ++cls) {
+            int32_t& next = delta_[state * alphabet_size_ + cls];
+            int32_t fallback = delta_[fail[state] * alphabet_size_ + cls];
+            if (next < 0) {
+                next = fallback;
+            } else {
+                fail[next] = fallback;
+                pending.push(next);
+            }
+        }
+    }
+}
+
+uint32_t keyword_matcher::scan(std::string_view text, uint32_t wanted) const
+{
+    uint32_t hit = always_;
+    if ((hit & wanted) == wanted || delta_.empty()) return hit;
+
+    size_t state = 0;
+    for (unsigned char c : text) {
+        state = static_cast<size_t>(delta_[state * alphabet_size_ + byte_class_[c]]);
+        if (output_[state]) {
+            hit |= output_[state];
+            if ((hit & wanted) == wanted) break;
+        }
+    }
+    return hit;
+}
@@ -0,0 +1,52 @@
+﻿#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 关键词类别 (位掩码)，一次扫描可以同时报告多个类别的命中
+enum keyword_class : uint32_t
+{
+    kw_single      = 1u << 0,  // 单选题关键词
+    kw_multi       = 1u << 1,  // 多选题关键词
+    kw_judge       = 1u << 2,  // 判断题关键词
+    kw_fill        = 1u << 3,  // 填空题关键词
+    kw_judge_true  = 1u << 4,  // 判断题 "对" 的取值
+    kw_judge_false = 1u << 5,  // 判断题 "错" 的取值
+    kw_garbage     = 1u << 6,  // 纯文本垃圾行关键词
+
+    kw_type_mask   = kw_single | kw_multi | kw_judge | kw_fill,
+    kw_judge_mask  = kw_judge_true | kw_judge_false,
+};
+
+// 多模式关键词匹配 (Aho-Corasick 自动机)
+// 所有关键词编译成一张按字节跳转的 DFA，对文本只扫描一遍即可得到命中的全部类别
+class keyword_matcher
+{
+public:
+    // 添加一个关键词；空关键词视为总是命中 (与 string_view::find("") 的语义一致)
+    void add(std::string_view keyword, uint32_t classes);
+
+    // 添加完成后构建自动机
+    void build();
+
+    // 扫描文本，返回命中的类别；wanted 中的类别全部命中后提前结束
+    [[nodiscard]] uint32_t scan(std::string_view text, uint32_t wanted = ~0u) const;
+
+private:
+    struct pattern
+    {
+        std::string text;
+        uint32_t classes;
+    };
+
+    std::vector<pattern> patterns_;
+    uint32_t always_ = 0;                 // 空关键词对应的类别
+
+    std::array<uint8_t, 256> byte_class_{}; // 字节 -> 字母表下标 (未出现在关键词中的字节都映射到 0)
+    size_t alphabet_size_ = 1;
+    std::vector<int32_t> delta_;          // 状态转移表: delta_[state * alphabet_size_ + cls]
+    std::vector<uint32_t> output_;        // 每个状态命中的类别 (已合并失败链上的输出)
+};
@@ -0,0 +1,82 @@
+﻿#include "line_splitter.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define LINE_SPLITTER_SSE2
+    #include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define LINE_SPLITTER_NEON
+    #include <arm_neon.h>
+#endif
+
+namespace
+{
+    bool is_blank(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+    bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+    // 16 字节的三种位图: 换行符、非空白字节、数字
+    struct masks16
+    {
+        uint64_t newline, nonblank, digit;
+    };
+
+    inline masks16 classify16(const char* p)
+    {
+#if defined(LINE_SPLITTER_SSE2)
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i newline = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n'));
+        __m128i blank = _mm_or_si128(_mm_or_si128(newline, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(' '))),
+                                     _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r'))));
+        // 有符号比较: 0x80 以上的字节为负数，不会落在 '0'..'9' 内
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(chunk, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(chunk, _mm_set1_epi8('9' + 1)));
+        return { static_cast<uint32_t>(_mm_movemask_epi8(newline)),
+                 static_cast<uint32_t>(~_mm_movemask_epi8(blank) & 0xFFFF),
+                 static_cast<uint32_t>(_mm_movemask_epi8(digit)) };
+#elif defined(LINE_SPLITTER_NEON)
+        static const uint8_t weights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+        const uint8x16_t w = vld1q_u8(weights);
+        auto to_mask = [&](uint8x16_t eq) {
+            uint8x16_t bits = vandq_u8(eq, w);
+            return vaddv_u8(vget_low_u8(bits)) | (static_cast<uint64_t>(vaddv_u8(vget_high_u8(bits))) << 8);
+        };
+        uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+        uint8x16_t newline = vceqq_u8(chunk, vdupq_n_u8('\n'));
+        uint8x16_t blank = vorrq_u8(vorrq_u8(newline, vceqq_u8(chunk, vdupq_n_u8(' '))),
+                                    vorrq_u8(vceqq_u8(chunk, vdupq_n_u8('\t')), vceqq_u8(chunk, vdupq_n_u8('\r'))));
+        uint8x16_t digit = vcleq_u8(vsubq_u8(chunk, vdupq_n_u8('0')), vdupq_n_u8(9));
+        return { to_mask(newline), to_mask(vmvnq_u8(blank)), to_mask(digit) };
+#else
+        masks16 m{ 0, 0, 0 };
+        for (int i = 0; i < 16; ++i) {
+            if (p[i] == '\n') m.newline |= uint64_t{ 1 } << i;
+            if (!is_blank(p[i])) m.nonblank |= uint64_t{ 1 } << i;
+            if (is_digit(p[i])) m.digit |= uint64_t{ 1 } << i;
+        }
+        return m;
+#endif
+    }
+}
+
+void line_splitter::refill()
+{
+    const char* p = text_.data() + window_;
+    size_t available = text_.size() - window_;
+
+    if (available >= window_size) {
+        mask_ = nonblank_ = digit_ = 0;
+        for (int k = 0; k < 4; ++k) {
+            masks16 m = classify16(p + 16 * k);
+            mask_ |= m.newline << (16 * k);
+            nonblank_ |= m.nonblank << (16 * k);
+            digit_ |= m.digit << (16 * k);
+        }
+        return;
+    }
+
+    // 文本末尾不足 64 字节: 逐字节处理，避免越界读取
+    mask_ = nonblank_ = digit_ = 0;
+    for (size_t i = 0; i < available; ++i) {
+        if (p[i] == '\n') mask_ |= uint64_t{ 1 } << i;
+        if (!is_blank(p[i])) nonblank_ |= uint64_t{ 1 } << i;
+        if (is_digit(p[i])) digit_ |= uint64_t{ 1 } << i;
+    }
+}
@@ -0,0 +1,103 @@
+﻿#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// 按行切分文本: 每次用 SIMD (SSE2 / NEON，其它平台为标量回退) 比较 64 字节，得到换行符位图，
+// 之后逐位取出行尾，短行很多时比每行调用一次 memchr 快
+// 与 "memchr 找 '\n'，最后一行可以没有换行符" 的切分结果完全一致
+// 同一遍比较还得到非空白字节和数字的位图，据此按行首第一个非空白字节给每行分类 (line_class)，
+// 调用方只对候选行做完整的题号 / 垃圾行检查
+class line_splitter
+{
+public:
+    // 行的分类位 (空白指空格、制表符和 '\r'，与 text_parser::trim 一致)
+    enum class_bit : uint8_t
+    {
+        blank = 1 << 0,                 // 空行或只有空白 (垃圾行)
+        question_candidate = 1 << 1,    // 第一个非空白字节是数字: 可能是题号行
+    };
+
+    // 从 pos (必须位于行首) 开始切分
+    line_splitter(std::string_view text, size_t pos) : text_(text), pos_(pos), window_(pos)
+    {
+        if (pos_ < text_.size()) refill();
+    }
+
+    // 下一行的起始偏移
+    size_t position() const { return pos_; }
+
+    // 取出下一行 (不含 '\n')；文本结束时返回 false
+    bool next(std::string_view& line)
+    {
+        if (pos_ >= text_.size()) return false;
+
+        // 行首在当前窗口内时直接查位图分类，否则 (行首空白跨窗口等少见情况) 取出整行后逐字节判断
+        bool classified = classify_in_window();
+
+        while (mask_ == 0) {
+            if (window_ + window_size >= text_.size()) {
+                // 最后一行没有换行符
+                line = text_.substr(pos_);
+                pos_ = text_.size();
+                if (!classified) classify(line);
+                return true;
+            }
+            window_ += window_size;
+            refill();
+        }
+
+        size_t line_end = window_ + std::countr_zero(mask_);
+        mask_ &= mask_ - 1;
+        line = text_.substr(pos_, line_end - pos_);
+        pos_ = line_end + 1;
+        if (!classified) classify(line);
+        return true;
+    }
+
+    // 上一次 next() 取出的行的分类 (class_bit 各位的组合，0 表示其它行)
+    uint8_t line_class() const { return class_; }
+
+private:
+    static constexpr size_t window_size = 64;
+
+    // 计算 [window_, window_ + 64) 内的换行符、非空白字节和数字的位图
+    void refill();
+
+    bool classify_in_window()
+    {
+        size_t offset = pos_ - window_;
+        if (offset >= window_size) return false;
+
+        // 行首之后第一个非空白字节和第一个换行符，谁在前决定是否空行
+        uint64_t nonblank = nonblank_ >> offset;
+        size_t first = nonblank ? std::countr_zero(nonblank) + offset : window_size;
+        size_t newline = mask_ ? std::countr_zero(mask_) : window_size;
+        if (first < newline) {
+            class_ = (digit_ >> first) & 1 ? question_candidate : 0;
+            return true;
+        }
+        if (newline < window_size) {
+            class_ = blank;
+            return true;
+        }
+        return false;
+    }
+
+    void classify(std::string_view line)
+    {
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string_view::npos) class_ = blank;
+        else class_ = line[first] >= '0' && line[first] <= '9' ? question_candidate : 0;
+    }
+
+    std::string_view text_;
+    size_t pos_;            // 下一行的起点
+    size_t window_;         // 当前 64 字节窗口的起点
+    uint64_t mask_ = 0;     // 窗口内尚未取出的换行符 (第 i 位对应 window_ + i)
+    uint64_t nonblank_ = 0; // 窗口内不是空格、制表符、'\r'、'\n' 的字节
+    uint64_t digit_ = 0;    // 窗口内的数字 '0'..'9'
+    uint8_t class_ = 0;     // 上一行的分类
+};
@@ -1,4 +1,5 @@
 ﻿#pragma once
+#include "../question.h"
 #include <string>
 
 struct parser_strategy
@@ -23,6 +24,19 @@ struct parser_strategy
 
     bool operator==(const parser_strategy&) const = default;
 
+    // 所有影响解析结果的字段的哈希 (不含名称)，用作解析缓存键的一部分
+    size_t hash() const
+    {
+        size_t h = stable_hash("");
+        for (const std::string* field : { &single_keywords, &multi_keywords, &judge_keywords, &fill_keywords,
+                                          &answer_keywords, &garbage_patterns, &judge_true_values, &judge_false_values })
+        {
+            h = stable_hash(*field, h);
+            h = stable_hash("\x1f", h); // 字段分隔符，避免 "ab"+"c" 与 "a"+"bc" 相同
+        }
+        return h;
+    }
+
     static parser_strategy get_default()
     {
         parser_strategy s;
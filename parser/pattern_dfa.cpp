@@ -0,0 +1,529 @@
+﻿#include "pattern_dfa.h"
+#include <algorithm>
+#include <map>
+#include <optional>
+
+namespace
+{
+    // 上限: 防止 {n,m} 展开或子集构造导致内存爆炸
+    constexpr int max_repeat = 1000;
+    constexpr int max_depth = 100;
+    constexpr size_t max_nfa_nodes = 200000;
+    constexpr size_t max_dfa_states = 20000;
+
+    bool is_digit(char c) { return c >= '0' && c <= '9'; }
+    bool is_alnum(char c) { return is_digit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+
+    int hex_value(char c)
+    {
+        if (is_digit(c)) return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+}
+
+// 递归下降解析模式并直接生成 Thompson NFA
+// 任何不在支持范围内的语法都返回失败，由调用方退回 std::regex
+struct pattern_dfa::compiler
+{
+    pattern_dfa& dfa;
+    std::string_view p;
+    size_t pos = 0;
+    int depth = 0;
+
+    // 语法树 (量词需要把子表达式复制多次，所以先建树再生成 NFA)
+    struct node
+    {
+        enum kind_type { set, cat, alt, repeat, bol, eol } kind;
+        int32_t set_index = -1;
+        std::vector<int32_t> kids{};
+        int min = 0, max = 0;   // repeat: max < 0 表示无上限
+    };
+    std::vector<node> tree{};
+
+    struct fragment { int32_t start, end; };
+
+    int32_t add_node(node n)
+    {
+        tree.push_back(std::move(n));
+        return static_cast<int32_t>(tree.size() - 1);
+    }
+
+    int32_t add_set(const byte_set& bits)
+    {
+        dfa.byte_sets_.push_back(bits);
+        return add_node({ node::set, static_cast<int32_t>(dfa.byte_sets_.size() - 1) });
+    }
+
+    bool at_end() const { return pos >= p.size(); }
+    char peek() const { return p[pos]; }
+
+    // ---- 解析 ----
+
+    std::optional<int32_t> parse_alt()
+    {
+        if (++depth > max_depth) return std::nullopt;
+
+        node alt{ node::alt };
+        while (true) {
+            auto branch = parse_cat();
+            if (!branch) return std::nullopt;
+            alt.kids.push_back(*branch);
+            if (at_end() || peek() != '|') break;
+            ++pos;
+        }
+
+        --depth;
+        if (alt.kids.size() == 1) return alt.kids.front();
+        return add_node(std::move(alt));
+    }
+
+    std::optional<int32_t> parse_cat()
+    {
+        node cat{ node::cat };
+        while (!at_end() && peek() != '|' && peek() != ')') {
+            auto atom = parse_atom();
+            if (!atom) return std::nullopt;
+
+            // 断言不能带量词
+            bool assertion = tree[*atom].kind == node::bol || tree[*atom].kind == node::eol;
+            auto quantified = parse_quantifier(*atom, assertion);
+            if (!quantified) return std::nullopt;
+            cat.kids.push_back(*quantified);
+        }
+        return add_node(std::move(cat));
+    }
+
+    static bool is_quantifier(char c) { return c == '*' || c == '+' || c == '?' || c == '{'; }
+
+    std::optional<int> parse_number()
+    {
+        size_t begin = pos;
+        int value = 0;
+        while (!at_end() && is_digit(peek())) {
+            value = value * 10 + (peek() - '0');
+            if (value > max_repeat) return std::nullopt;
+            ++pos;
+        }
+        if (pos == begin) return std::nullopt;
+        return value;
+    }
+
+    std::optional<int32_t> parse_quantifier(int32_t atom, bool assertion)
+    {
+        if (at_end() || !is_quantifier(peek())) return atom;
+        if (assertion) return std::nullopt;
+
+        int min = 0, max = -1;
+        char c = p[pos++];
+        if (c == '+') {
+            min = 1;
+        } else if (c == '?') {
+            max = 1;
+        } else if (c == '{') {
+            auto n = parse_number();
+            if (!n || at_end()) return std::nullopt;
+            min = max = *n;
+            if (peek() == ',') {
+                ++pos;
+                max = -1;
+                if (!at_end() && peek() != '}') {
+                    auto m = parse_number();
+                    if (!m || *m < min) return std::nullopt;
+                    max = *m;
+                }
+            }
+            if (at_end() || peek() != '}') return std::nullopt;
+            ++pos;
+        }
+
+        // 非贪婪后缀不影响整行匹配的结果
+        if (!at_end() && peek() == '?') ++pos;
+        // 连续量词 (如 a**) 在 ECMAScript 中是语法错误
+        if (!at_end() && is_quantifier(peek())) return std::nullopt;
+
+        node rep{ node::repeat };
+        rep.kids.push_back(atom);
+        rep.min = min;
+        rep.max = max;
+        return add_node(std::move(rep));
+    }
+
+    // 转义 (反斜杠之后的部分): 返回对应的字节集合
+    std::optional<byte_set> parse_escape()
+    {
+        if (at_end()) return std::nullopt;
+        char e = p[pos++];
+        byte_set bits;
+
+        auto add_range = [&](int lo, int hi) { for (int b = lo; b <= hi; ++b) bits.set(b); };
+        switch (e) {
+        case 'd': case 'D':
+            add_range('0', '9');
+            break;
+        case 's': case 'S':
+            // 与 std::regex 在 "C" locale 下的 isspace 一致
+            bits.set(' ');
+            add_range('\t', '\r');
+            break;
+        case 'w': case 'W':
+            add_range('0', '9');
+            add_range('a', 'z');
+            add_range('A', 'Z');
+            bits.set('_');
+            break;
+        case 't': bits.set('\t'); return bits;
+        case 'n': bits.set('\n'); return bits;
+        case 'r': bits.set('\r'); return bits;
+        case 'f': bits.set('\f'); return bits;
+        case 'v': bits.set('\v'); return bits;
+        case '0':
+            if (!at_end() && is_digit(peek())) return std::nullopt;
+            bits.set(0);
+            return bits;
+        case 'x': {
+            if (pos + 2 > p.size()) return std::nullopt;
+            int hi = hex_value(p[pos]), lo = hex_value(p[pos + 1]);
+            if (hi < 0 || lo < 0) return std::nullopt;
+            pos += 2;
+            bits.set(hi * 16 + lo);
+            return bits;
+        }
+        default:
+            // 其它字母数字转义 (\b \B \1 \u \c ...) 以及非 ASCII 字节不支持
+            if (is_alnum(e) || static_cast<unsigned char>(e) >= 0x80) return std::nullopt;
+            bits.set(static_cast<unsigned char>(e));
+            return bits;
+        }
+
+        if (e == 'D' || e == 'S' || e == 'W') bits.flip();
+        return bits;
+    }
+
+    std::optional<int32_t> parse_class()
+    {
+        byte_set bits;
+        bool negate = false;
+        if (!at_end() && peek() == '^') {
+            negate = true;
+            ++pos;
+        }
+        // 空字符类 [] / [^] 不支持
+        if (!at_end() && peek() == ']') return std::nullopt;
+
+        // 读取一个类成员: 单个字节返回其值，转义类 (\d 等) 返回 -1 并直接并入 bits
+        auto read_item = [&]() -> std::optional<int> {
+            if (at_end()) return std::nullopt;
+            char c = p[pos++];
+            if (c == '[') return std::nullopt;  // [:alpha:] 等 POSIX 类
+            if (c != '\\') return static_cast<unsigned char>(c);
+            if (!at_end() && (peek() == 'b' || peek() == 'B')) return std::nullopt;
+
+            bool single = !at_end() && std::string_view("dDsSwW").find(peek()) == std::string_view::npos;
+            auto escaped = parse_escape();
+            if (!escaped) return std::nullopt;
+            if (!single) {
+                bits |= *escaped;
+                return -1;
+            }
+            for (int b = 0; b < 256; ++b) {
+                if ((*escaped)[b]) return b;
+            }
+            return std::nullopt;
+        };
+
+        while (true) {
+            if (at_end()) return std::nullopt;
+            if (peek() == ']') {
+                ++pos;
+                break;
+            }
+
+            auto lo = read_item();
+            if (!lo) return std::nullopt;
+            if (*lo < 0) continue;
+
+            // 范围 a-z (只支持 ASCII 端点)
+            if (pos + 1 < p.size() && peek() == '-' && p[pos + 1] != ']') {
+                ++pos;
+                auto hi = read_item();
+                if (!hi || *hi < 0 || *lo >= 0x80 || *hi >= 0x80 || *lo > *hi) return std::nullopt;
+                for (int b = *lo; b <= *hi; ++b) bits.set(b);
+                continue;
+            }
+            bits.set(*lo);
+        }
+
+        if (negate) bits.flip();
+        return add_set(bits);
+    }
+
+    std::optional<int32_t> parse_atom()
+    {
+        char c = p[pos++];
+        switch (c) {
+        case '(': {
+            if (!at_end() && peek() == '?') {
+                if (pos + 1 >= p.size() || p[pos + 1] != ':') return std::nullopt;  // 前瞻等
+                pos += 2;
+            }
+            auto inner = parse_alt();
+            if (!inner || at_end() || peek() != ')') return std::nullopt;
+            ++pos;
+            return inner;
+        }
+        case '[':
+            return parse_class();
+        case '.': {
+            // ECMAScript: . 不匹配换行符
+            byte_set bits;
+            bits.set();
+            bits.reset('\n');
+            bits.reset('\r');
+            return add_set(bits);
+        }
+        case '^':
+            return add_node({ node::bol });
+        case '$':
+            return add_node({ node::eol });
+        case '\\': {
+            auto escaped = parse_escape();
+            if (!escaped) return std::nullopt;
+            return add_set(*escaped);
+        }
+        case '*': case '+': case '?': case '{': case '}': case ']':
+            return std::nullopt;
+        default: {
+            byte_set bits;
+            bits.set(static_cast<unsigned char>(c));
+            return add_set(bits);
+        }
+        }
+    }
+
+    // ---- 生成 NFA ----
+
+    int32_t emit(nfa_node::kind_type kind, int32_t set = -1, int32_t out = -1, int32_t out1 = -1)
+    {
+        dfa.nfa_.push_back({ kind, set, out, out1 });
+        return static_cast<int32_t>(dfa.nfa_.size() - 1);
+    }
+
+    // 返回的 end 总是一个出边待连接的 eps 节点
+    std::optional<fragment> compile(int32_t index)
+    {
+        if (dfa.nfa_.size() > max_nfa_nodes) return std::nullopt;
+
+        const node& n = tree[index];
+        switch (n.kind) {
+        case node::set: {
+            int32_t end = emit(nfa_node::eps);
+            return fragment{ emit(nfa_node::bytes, n.set_index, end), end };
+        }
+        case node::bol:
+        case node::eol: {
+            int32_t end = emit(nfa_node::eps);
+            return fragment{ emit(n.kind == node::bol ? nfa_node::bol : nfa_node::eol, -1, end), end };
+        }
+        case node::cat: {
+            int32_t start = emit(nfa_node::eps);
+            fragment whole{ start, start };
+            for (int32_t kid : n.kids) {
+                auto f = compile(kid);
+                if (!f) return std::nullopt;
+                dfa.nfa_[whole.end].out = f->start;
+                whole.end = f->end;
+            }
+            return whole;
+        }
+        case node::alt: {
+            int32_t end = emit(nfa_node::eps);
+            int32_t start = -1;
+            // 从后往前串起分支节点
+            for (auto it = n.kids.rbegin(); it != n.kids.rend(); ++it) {
+                auto f = compile(*it);
+                if (!f) return std::nullopt;
+                dfa.nfa_[f->end].out = end;
+                start = start < 0 ? f->start : emit(nfa_node::eps, -1, f->start, start);
+            }
+            return fragment{ start, end };
+        }
+        case node::repeat: {
+            int32_t start = emit(nfa_node::eps);
+            fragment whole{ start, start };
+            int32_t kid = n.kids.front();
+            int min = n.min, max = n.max;
+
+            for (int i = 0; i < min; ++i) {
+                auto f = compile(kid);
+                if (!f) return std::nullopt;
+                dfa.nfa_[whole.end].out = f->start;
+                whole.end = f->end;
+            }
+
+            if (max < 0) {
+                auto f = compile(kid);
+                if (!f) return std::nullopt;
+                int32_t end = emit(nfa_node::eps);
+                int32_t loop = emit(nfa_node::eps, -1, f->start, end);
+                dfa.nfa_[f->end].out = loop;
+                dfa.nfa_[whole.end].out = loop;
+                whole.end = end;
+            } else {
+                for (int i = min; i < max; ++i) {
+                    auto f = compile(kid);
+                    if (!f) return std::nullopt;
+                    int32_t end = emit(nfa_node::eps);
+                    int32_t branch = emit(nfa_node::eps, -1, f->start, end);
+                    dfa.nfa_[f->end].out = end;
+                    dfa.nfa_[whole.end].out = branch;
+                    whole.end = end;
+                }
+            }
+            return whole;
+        }
+        }
+        return std::nullopt;
+    }
+
+    std::optional<int32_t> run()
+    {
+        auto root = parse_alt();
+        if (!root || !at_end()) return std::nullopt;
+
+        auto f = compile(*root);
+        if (!f) return std::nullopt;
+        dfa.nfa_[f->end].out = emit(nfa_node::accept);
+        return f->start;
+    }
+};
+
+bool pattern_dfa::add(std::string_view pattern)
+{
+    size_t nfa_size = nfa_.size();
+    size_t set_count = byte_sets_.size();
+
+    compiler c{ *this, pattern };
+    auto start = c.run();
+    if (!start) {
+        // 回滚本模式生成的节点
+        nfa_.resize(nfa_size);
+        byte_sets_.resize(set_count);
+        return false;
+    }
+    starts_.push_back(*start);
+    return true;
+}
+
+void pattern_dfa::closure(std::vector<int32_t>& states, bool at_start, bool at_end, std::vector<uint8_t>& seen) const
+{
+    // 沿 eps 边展开；结果只保留消耗字节的节点、接受节点和尚未到行尾的 $ 节点
+    std::vector<int32_t> stack(states.begin(), states.end());
+    std::vector<int32_t> visited;
+    states.clear();
+
+    while (!stack.empty()) {
+        int32_t s = stack.back();
+        stack.pop_back();
+        if (s < 0 || seen[s]) continue;
+        seen[s] = 1;
+        visited.push_back(s);
+
+        const nfa_node& n = nfa_[s];
+        switch (n.kind) {
+        case nfa_node::eps:
+            stack.push_back(n.out1);
+            stack.push_back(n.out);
+            break;
+        case nfa_node::bol:
+            if (at_start) stack.push_back(n.out);
+            break;
+        case nfa_node::eol:
+            if (at_end) stack.push_back(n.out);
+            else states.push_back(s);
+            break;
+        case nfa_node::bytes:
+        case nfa_node::accept:
+            states.push_back(s);
+            break;
+        }
+    }
+
+    for (int32_t s : visited) seen[s] = 0;
+    std::sort(states.begin(), states.end());
+}
+
+bool pattern_dfa::build()
+{
+    delta_.clear();
+    accepting_.clear();
+    if (starts_.empty()) return true;
+
+    // 1. 字节等价类: 被所有字节集合以相同方式划分的字节共用一列
+    std::map<std::vector<bool>, uint8_t> signatures;
+    std::array<uint8_t, 256> representative{};
+    for (int b = 0; b < 256; ++b) {
+        std::vector<bool> signature(byte_sets_.size());
+        for (size_t i = 0; i < byte_sets_.size(); ++i) signature[i] = byte_sets_[i][b];
+
+        auto [it, inserted] = signatures.try_emplace(std::move(signature), static_cast<uint8_t>(signatures.size()));
+        if (inserted) representative[it->second] = static_cast<uint8_t>(b);
+        byte_class_[b] = it->second;
+    }
+    class_count_ = signatures.size();
+
+    // 2. 子集构造: 状态 0 为死状态，状态 1 为初始状态 (只有它允许 ^ 通过，因此不参与去重)
+    std::vector<uint8_t> seen(nfa_.size(), 0);
+    std::vector<std::vector<int32_t>> sets(2);
+    std::map<std::vector<int32_t>, int32_t> index{ { {}, 0 } };
+
+    sets[1] = starts_;
+    closure(sets[1], true, false, seen);
+
+    std::vector<int32_t> next;
+    for (size_t state = 0; state < sets.size(); ++state) {
+        delta_.resize(sets.size() * class_count_, 0);
+
+        for (size_t cls = 0; cls < class_count_; ++cls) {
+            next.clear();
+            for (int32_t s : sets[state]) {
+                const nfa_node& n = nfa_[s];
+                if (n.kind == nfa_node::bytes && byte_sets_[n.set][representative[cls]]) next.push_back(n.out);
+            }
+            closure(next, false, false, seen);
+
+            auto [it, inserted] = index.try_emplace(next, static_cast<int32_t>(sets.size()));
+            if (inserted) {
+                if (sets.size() >= max_dfa_states) {
+                    delta_.clear();
+                    return false;
+                }
+                sets.push_back(next);
+            }
+            delta_[state * class_count_ + cls] = it->second;
+        }
+    }
+    delta_.resize(sets.size() * class_count_, 0);
+
+    // 3. 接受状态: 到达行尾后 ($ 放行) 能走到任一模式的接受节点
+    accepting_.assign(sets.size(), 0);
+    for (size_t state = 1; state < sets.size(); ++state) {
+        next = sets[state];
+        closure(next, state == 1, true, seen);
+        accepting_[state] = std::any_of(next.begin(), next.end(), [&](int32_t s) { return nfa_[s].kind == nfa_node::accept; });
+    }
+    return true;
+}
+
+bool pattern_dfa::match(std::string_view text) const
+{
+    if (delta_.empty()) return false;
+
+    size_t state = 1;
+    for (unsigned char c : text) {
+        state = static_cast<size_t>(delta_[state * class_count_ + byte_class_[c]]);
+        if (state == 0) return false;
+    }
+    return accepting_[state];
+}
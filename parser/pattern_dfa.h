@@ -0,0 +1,57 @@
+﻿#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 多个正则表达式合并成的确定有限自动机 (DFA)，用于整行匹配 (与 std::regex_match 语义一致)
+// 按字节匹配 (与 std::regex 对 char 的处理相同): 字符类中的中文按 UTF-8 字节加入集合
+// 支持的语法子集:
+//   字面量、转义 (\d \D \s \S \w \W \t \n \r \f \v \xHH 及标点转义)、. 、[...] / [^...]、
+//   分组 (...) / (?:...)、| 、* + ? {n} {n,} {n,m} (可带非贪婪后缀 ?)、^ 和 $
+// 不支持的语法 (反向引用、断言 \b、前瞻等) 由 add() 返回 false，调用方应退回 std::regex
+class pattern_dfa
+{
+public:
+    // 添加一个模式；语法不在支持范围内时返回 false，且不修改已添加的内容
+    bool add(std::string_view pattern);
+
+    // 构建合并后的 DFA；状态数超过上限时返回 false (调用方应把全部模式退回 std::regex)
+    bool build();
+
+    // 是否没有任何模式
+    [[nodiscard]] bool empty() const { return starts_.empty(); }
+
+    // 文本是否整体匹配任意一个模式
+    [[nodiscard]] bool match(std::string_view text) const;
+
+private:
+    using byte_set = std::bitset<256>;
+
+    // Thompson NFA 节点
+    struct nfa_node
+    {
+        enum kind_type : uint8_t { eps, bytes, bol, eol, accept };
+        kind_type kind = eps;
+        int32_t set = -1;       // bytes: byte_sets_ 下标
+        int32_t out = -1;       // 后继
+        int32_t out1 = -1;      // eps 的第二个后继 (分支)
+    };
+
+    std::vector<nfa_node> nfa_;
+    std::vector<byte_set> byte_sets_;
+    std::vector<int32_t> starts_;           // 每个模式的起始节点
+
+    // DFA: 状态 0 为死状态，状态 1 为初始状态
+    std::array<uint8_t, 256> byte_class_{};
+    size_t class_count_ = 0;
+    std::vector<int32_t> delta_;            // delta_[state * class_count_ + cls]
+    std::vector<uint8_t> accepting_;
+
+    struct compiler;
+
+    void closure(std::vector<int32_t>& states, bool at_start, bool at_end, std::vector<uint8_t>& seen) const;
+};
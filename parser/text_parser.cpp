@@ -1,8 +1,13 @@
 ﻿#include "text_parser.h"
+#include "line_splitter.h"
 #include <ranges>
 #include <algorithm>
 #include <charconv>
 #include <iostream>
+#include <thread>
+#include <array>
+#include <cstring>
+#include <new>
 
 // 辅助函数：拆分 string_view 而不使用 ranges::views::split
 std::vector<std::string_view> split_view(std::string_view str, char delim) {
@@ -21,6 +26,7 @@ std::vector<std::string_view> split_view(std::string_view str, char delim) {
     return result;
 }
 
+
 text_parser::text_parser(parser_strategy strategy) 
     : strategy_(std::move(strategy))
 {
@@ -31,17 +37,61 @@ void text_parser::compile_patterns()
 {
     // 只编译垃圾行过滤的正则表达式
     // 题目识别和选项解析已改为手动 UTF-8 字节处理，不再使用正则表达式
+    // 正则模式优先编译进同一个 DFA，每行只扫描一遍；DFA 不支持的语法退回 std::regex
     re_garbage_list_.clear();
+    unsupported_patterns_.clear();
+    garbage_dfa_ = pattern_dfa{};
+
+    auto fallback = [this](const std::string& pattern) {
+        try {
+            re_garbage_list_.emplace_back(pattern, std::regex::optimize);
+            unsupported_patterns_.push_back(pattern);
+        } catch (...) {}
+    };
+
+    std::vector<std::string> dfa_patterns;
     for (auto pattern_sv : split_view(strategy_.garbage_patterns, ','))
     {
         std::string pattern(pattern_sv);
         // 最小化启发式检测正则表达式语法
         if (pattern.find_first_of("^$*+\\") != std::string::npos)
         {
-            try {
-                re_garbage_list_.emplace_back(pattern, std::regex::optimize);
-            } catch (...) {}
+            if (garbage_dfa_.add(pattern)) dfa_patterns.push_back(std::move(pattern));
+            else fallback(pattern);
+        }
+    }
+    if (!garbage_dfa_.build()) {
+        // 合并后状态数过多，全部退回 std::regex
+        garbage_dfa_ = pattern_dfa{};
+        for (const auto& pattern : dfa_patterns) fallback(pattern);
+    }
+
+    // 所有纯文本关键词编译进同一个自动机，每行/每块只需扫描一遍
+    keywords_ = keyword_matcher{};
+    auto add_csv = [this](std::string_view csv, uint32_t classes) {
+        for (auto kw : split_view(csv, ',')) {
+            keywords_.add(trim(kw), classes);
         }
+    };
+    add_csv(strategy_.single_keywords, kw_single);
+    add_csv(strategy_.multi_keywords, kw_multi);
+    add_csv(strategy_.judge_keywords, kw_judge);
+    add_csv(strategy_.fill_keywords, kw_fill);
+    add_csv(strategy_.judge_true_values, kw_judge_true);
+    add_csv(strategy_.judge_false_values, kw_judge_false);
+
+    for (auto pattern_sv : split_view(strategy_.garbage_patterns, ',')) {
+        std::string_view pattern = trim(pattern_sv);
+        // 空模式和正则模式不参与纯文本匹配
+        if (pattern.empty() || pattern.find_first_of("^$*+\\") != std::string_view::npos) continue;
+        keywords_.add(pattern, kw_garbage);
+    }
+    keywords_.build();
+
+    // 答案关键词需要命中位置和优先顺序，单独保存
+    answer_keywords_.clear();
+    for (auto kw : split_view(strategy_.answer_keywords, ',')) {
+        answer_keywords_.emplace_back(trim(kw));
     }
 }
 
@@ -60,23 +110,14 @@ bool text_parser::is_garbage_line(std::string_view line) const
     auto t = trim(line);
     if (t.empty()) return true;
 
-    // 正则表达式检查 (regex_match 需要遗留转换)
-    // 注意: regex_match 需要 std::string 或迭代器。string_view 上的迭代器可以使用。
+    // 正则表达式检查: 合并的 DFA 一次扫描完成，只有 DFA 不支持的模式才逐个 regex_match
+    if (garbage_dfa_.match(t)) return true;
     for (const auto& re : re_garbage_list_) {
         if (std::regex_match(t.begin(), t.end(), re)) return true;
     }
 
-    // Plain text check
-    for (auto pattern_sv : split_view(strategy_.garbage_patterns, ',')) {
-        std::string_view pattern = trim(pattern_sv);
-        if (pattern.empty()) continue;
-        
-        // 跳过正则模式
-        if (pattern.find_first_of("^$*+\\") != std::string_view::npos) continue;
-
-        if (t.find(pattern) != std::string_view::npos) return true;
-    }
-    return false;
+    // 纯文本检查 (e.g., "AI讲解")
+    return keywords_.scan(t, kw_garbage) & kw_garbage;
 }
 
 bool text_parser::is_question_start(std::string_view line) const
@@ -114,29 +155,23 @@ bool text_parser::is_question_start(std::string_view line) const
     return false;
 }
 
-bool text_parser::contains_keyword(std::string_view text, std::string_view keywords_csv) const
+bool text_parser::starts_block(std::string_view line) const
 {
-    for (auto kw : split_view(keywords_csv, ',')) {
-        if (text.find(trim(kw)) != std::string_view::npos) return true;
-    }
-    return false;
-}
-
-bool text_parser::is_judge_true(std::string_view answer) const {
-    return contains_keyword(answer, strategy_.judge_true_values);
-}
-
-bool text_parser::is_judge_false(std::string_view answer) const {
-    return contains_keyword(answer, strategy_.judge_false_values);
+    // 处理 CR
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    // 先做廉价的题号检查: 绝大多数行 (选项、答案、正文) 在这里就被排除，
+    // 只有题号开头的候选行才需要跑垃圾行 DFA 和关键词扫描；两个条件都只看这一行，交换顺序不影响结果
+    return is_question_start(line) && !is_garbage_line(line);
 }
 
 question_type text_parser::detect_type(std::string_view block, std::string_view answer_raw) const
 {
-    // 关键词优先级
-    if (contains_keyword(block, strategy_.multi_keywords)) return question_type::multi;
-    if (contains_keyword(block, strategy_.judge_keywords)) return question_type::judge;
-    if (contains_keyword(block, strategy_.fill_keywords)) return question_type::fill;
-    if (contains_keyword(block, strategy_.single_keywords)) return question_type::single;
+    // 关键词优先级 (一次扫描得到所有题型关键词的命中情况)
+    uint32_t hit = keywords_.scan(block, kw_type_mask);
+    if (hit & kw_multi) return question_type::multi;
+    if (hit & kw_judge) return question_type::judge;
+    if (hit & kw_fill) return question_type::fill;
+    if (hit & kw_single) return question_type::single;
 
     // 辅助函数：检测选项是否存在（支持半角和全角点）
     auto has_option = [](std::string_view text, char letter) -> bool {
@@ -158,7 +193,7 @@ question_type text_parser::detect_type(std::string_view block, std::string_view
     };
 
     // 答案推断
-    if (is_judge_true(answer_raw) || is_judge_false(answer_raw)) {
+    if (keywords_.scan(answer_raw, kw_judge_mask) & kw_judge_mask) {
         if (!has_option(block, 'C') && !has_option(block, 'D'))
             return question_type::judge;
         return question_type::single; // A/B options might be single choice
@@ -182,69 +217,249 @@ question_type text_parser::detect_type(std::string_view block, std::string_view
 
 // 核心解析
 
-std::vector<question> text_parser::parse(std::string_view content, std::string_view file_name) const
+std::vector<size_t> text_parser::find_block_starts(std::string_view content, size_t begin, size_t end) const
 {
-    std::vector<question> results;
-    
-    // 我们需要将分配的块字符串保存在某处，才能对其进行修改，
-    // 但这里我们只是对原始视图进行切片。
-    // 但是，原来的逻辑是"累积"行。如果行在内存中不连续
-    // (在一个文件读取中它们确实是连续的)，我们可以只使用 start/end 指针。
-    
-    const char* file_start = content.data();
-    const char* file_end = content.data() + content.size();
-    const char* cur = file_start;
-    const char* block_start = nullptr;
-
-    auto flush_block = [&](const char* end_ptr) {
-        if (block_start && end_ptr > block_start) {
-            std::string_view block_sv(block_start, end_ptr - block_start);
-            question q = parse_single_block(block_sv, file_name);
+    // 扫描起点落在 [begin, end) 内的每一行 (begin 必须位于行首)
+    std::vector<size_t> starts;
+    line_splitter lines(content, begin);
+    std::string_view line;
+
+    // 逐行迭代
+    while (lines.position() < end && lines.next(line)) {
+        // 其余行都是当前块的延续；第一个题号之前的文本被丢弃
+        // 行首不是数字的行不可能是题号，不必做完整检查
+        if ((lines.line_class() & line_splitter::question_candidate) && starts_block(line)) {
+            starts.push_back(line.data() - content.data());
+        }
+    }
+    return starts;
+}
+
+std::vector<size_t> text_parser::find_all_block_starts(std::string_view content, size_t worker_count) const
+{
+    // 每行是否开始新题目只取决于这一行本身，因此可以按行边界切成若干段并行扫描，再按顺序拼接
+    if (worker_count <= 1) {
+        return find_block_starts(content, 0, content.size());
+    }
+
+    std::vector<size_t> bounds{ 0 };
+    for (size_t i = 1; i < worker_count; ++i) {
+        size_t pos = std::max(content.size() * i / worker_count, bounds.back());
+        // 对齐到下一行的行首
+        size_t nl = content.find('\n', pos == 0 ? 0 : pos - 1);
+        bounds.push_back(nl == std::string_view::npos ? content.size() : nl + 1);
+    }
+    bounds.push_back(content.size());
+
+    std::vector<std::vector<size_t>> partial(worker_count);
+    {
+        std::vector<std::jthread> workers;
+        for (size_t i = 0; i < worker_count; ++i) {
+            workers.emplace_back([&, i] { partial[i] = find_block_starts(content, bounds[i], bounds[i + 1]); });
+        }
+    } // jthread 析构时自动 join
+
+    std::vector<size_t> starts;
+    for (const auto& part : partial) starts.insert(starts.end(), part.begin(), part.end());
+    return starts;
+}
+
+size_t text_parser::worker_count_for(size_t content_size, size_t max_workers)
+{
+    // 大文件在单个文件内部也并行: 工作线程数不超过 CPU 核心数，调用方给出上限时再取较小者
+    if (content_size < parallel_threshold) return 1;
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    return max_workers > 0 ? std::min(cores, max_workers) : cores;
+}
+
+std::vector<question> text_parser::parse(std::string_view content, uint32_t file_id, const arena_source& arenas, size_t max_workers) const
+{
+    size_t worker_count = worker_count_for(content.size(), max_workers);
+
+    // 第一阶段: 找出所有题目块的起点
+    std::vector<size_t> starts = find_all_block_starts(content, worker_count);
+
+    // 第二阶段: 逐块解析，块 i 为 [starts[i], starts[i + 1])，最后一块延伸到文件末尾
+    // 每个分片使用自己的内存区
+    auto parse_blocks = [&](size_t first, size_t last, std::vector<question>& out) {
+        size_t bytes = first < last ? (last < starts.size() ? starts[last] : content.size()) - starts[first] : 0;
+        std::pmr::memory_resource* resource = arenas ? arenas(bytes) : std::pmr::get_default_resource();
+        for (size_t i = first; i < last; ++i) {
+            size_t end = i + 1 < starts.size() ? starts[i + 1] : content.size();
+            question q = parse_single_block(content.substr(starts[i], end - starts[i]), file_id, starts[i], resource);
             if (q.type != question_type::unknown) {
-                results.push_back(std::move(q));
+                out.push_back(std::move(q));
             }
         }
     };
 
-    // 逐行迭代
-    while (cur < file_end) {
-        const char* line_end = static_cast<const char*>(memchr(cur, '\n', file_end - cur));
-        if (!line_end) line_end = file_end;
-        
-        std::string_view line_full(cur, line_end - cur);
-        // 处理 CR
-        if (!line_full.empty() && line_full.back() == '\r') line_full.remove_suffix(1);
-
-        if (!is_garbage_line(line_full)) {
-            if (is_question_start(line_full)) {
-                // 新题目开始，刷新前一个
-                flush_block(cur); // flush up to start of this line
-                block_start = cur; // Mark start of new block
-            } else {
-                // 当前块的延续。
-                // 如果这是第一行有效行且不是问题开始，
-                // 我们是否只在块开始后才将其视为块的一部分？
-                // 或者文件的第一行是垃圾或标题。
-                if (!block_start) {
-                    // 尝试宽容处理：如果我们还没有找到数字，如果它看起来像文本，也许这*就是*问题开始。
-                    // 但是依靠 "1." 更安全。让我们坚持逻辑：丢弃第一个问题编号之前的文本。
-                }
+    std::vector<question> results;
+    worker_count = std::min(worker_count, starts.size() / min_blocks_per_shard + 1);
+    if (worker_count <= 1) {
+        results.reserve(starts.size());
+        parse_blocks(0, starts.size(), results);
+        return results;
+    }
+
+    // 按块数均分给各线程，结果按分片顺序拼接，与串行解析完全一致
+    std::vector<std::vector<question>> shards(worker_count);
+    {
+        std::vector<std::jthread> workers;
+        for (size_t i = 0; i < worker_count; ++i) {
+            workers.emplace_back([&, i] {
+                size_t first = starts.size() * i / worker_count;
+                size_t last = starts.size() * (i + 1) / worker_count;
+                shards[i].reserve(last - first);
+                parse_blocks(first, last, shards[i]);
+            });
+        }
+    }
+
+    size_t total = 0;
+    for (const auto& shard : shards) total += shard.size();
+    results.reserve(total);
+    for (auto& shard : shards) {
+        results.insert(results.end(), std::make_move_iterator(shard.begin()), std::make_move_iterator(shard.end()));
+    }
+    return results;
+}
+
+void text_parser::parse_views(std::string_view content, uint32_t file_id, question_view_list& out, size_t max_workers) const
+{
+    size_t worker_count = worker_count_for(content.size(), max_workers);
+    std::vector<size_t> starts = find_all_block_starts(content, worker_count);
+
+    // 与 parse() 的第二阶段相同，只是不生成字符串
+    auto parse_blocks = [&](size_t first, size_t last, std::pmr::memory_resource* arena, std::vector<question_view>& views) {
+        for (size_t i = first; i < last; ++i) {
+            size_t end = i + 1 < starts.size() ? starts[i + 1] : content.size();
+            question_view v = parse_block_view(content.substr(starts[i], end - starts[i]), arena);
+            if (v.type != question_type::unknown) {
+                v.file_id = file_id;
+                v.block_offset = starts[i];
+                views.push_back(v);
             }
         }
+    };
 
-        cur = line_end + 1; // 移动到下一行
+    worker_count = std::min(worker_count, starts.size() / min_blocks_per_shard + 1);
+    if (worker_count <= 1) {
+        out.views().reserve(out.size() + starts.size());
+        parse_blocks(0, starts.size(), out.new_arena(), out.views());
+        return;
     }
 
-    // 刷新最后一个块
-    flush_block(file_end);
+    // 内存区在启动线程前创建，每个分片独占一个
+    std::vector<std::pmr::memory_resource*> shard_arenas;
+    for (size_t i = 0; i < worker_count; ++i) shard_arenas.push_back(out.new_arena());
 
-    return results;
+    std::vector<std::vector<question_view>> shards(worker_count);
+    {
+        std::vector<std::jthread> workers;
+        for (size_t i = 0; i < worker_count; ++i) {
+            workers.emplace_back([&, i] {
+                size_t first = starts.size() * i / worker_count;
+                size_t last = starts.size() * (i + 1) / worker_count;
+                shards[i].reserve(last - first);
+                parse_blocks(first, last, shard_arenas[i], shards[i]);
+            });
+        }
+    }
+
+    for (const auto& shard : shards) out.views().insert(out.views().end(), shard.begin(), shard.end());
+}
+
+// 流式解析
+
+text_parser::stream::stream(const text_parser& parser, uint32_t file_id, sink_type sink, std::pmr::memory_resource* resource)
+    : parser_(parser), file_id_(file_id), sink_(std::move(sink)), resource_(resource)
+{
+}
+
+void text_parser::stream::feed(std::string_view chunk)
+{
+    buffer_.append(chunk);
+    scan(false);
+}
+
+void text_parser::stream::finish()
+{
+    scan(true);
+    emit_block(buffer_.size());
+    buffer_.clear();
+    scanned_ = block_begin_ = 0;
+    in_block_ = false;
+    dropped_ = 0;
+}
+
+void text_parser::stream::emit_block(size_t end)
+{
+    if (!in_block_ || end <= block_begin_) return;
+
+    question q = parser_.parse_single_block(std::string_view(buffer_).substr(block_begin_, end - block_begin_), file_id_,
+                                            dropped_ + block_begin_, resource_);
+    if (q.type != question_type::unknown) {
+        sink_(std::move(q));
+    }
+}
+
+void text_parser::stream::scan(bool at_eof)
+{
+    // 与 parse() 相同的逐行逻辑，只是最后一行不完整时留到下一次 feed
+    std::string_view buffer = buffer_;
+    line_splitter lines(buffer, scanned_);
+    size_t pos = scanned_;
+    std::string_view line;
+    while (lines.next(line)) {
+        // 没有换行符的最后一行
+        if (!at_eof && line.data() + line.size() == buffer.data() + buffer.size()) break;
+
+        if ((lines.line_class() & line_splitter::question_candidate) && parser_.starts_block(line)) {
+            emit_block(pos);
+            block_begin_ = pos;
+            in_block_ = true;
+        }
+
+        pos = lines.position();
+    }
+    pos = std::min(pos, buffer_.size());
+
+    // 丢弃已经用不到的数据: 已产出的题目块，或第一个题号之前的文本
+    // 每次 feed 只搬移一次，避免每道题都移动缓冲区
+    size_t keep_from = in_block_ ? block_begin_ : pos;
+    buffer_.erase(0, keep_from);
+    dropped_ += keep_from;
+    if (in_block_) block_begin_ -= keep_from;
+    scanned_ = pos - keep_from;
+}
+
+question text_parser::parse_single_block(std::string_view block, uint32_t file_id, uint64_t block_offset, std::pmr::memory_resource* resource) const
+{
+    // 视图中改写过的文本只在本次调用内使用，按线程复用同一块缓冲区 (release 后回到初始缓冲区，不释放内存)
+    thread_local std::array<std::byte, 16 * 1024> scratch_buffer;
+    thread_local std::pmr::monotonic_buffer_resource scratch(scratch_buffer.data(), scratch_buffer.size());
+    scratch.release();
+
+    question_view v = parse_block_view(block, &scratch);
+    if (v.type == question_type::unknown) return question(resource); // 调用方会丢弃
+
+    v.file_id = file_id;
+    v.block_offset = block_offset;
+    return v.materialize(resource);
+}
+
+// 复制到内存区中 (视图需要引用源文本之外的内容时使用)
+static std::string_view store(std::pmr::memory_resource* arena, std::string_view text)
+{
+    if (text.empty()) return {};
+    char* data = static_cast<char*>(arena->allocate(text.size(), 1));
+    std::memcpy(data, text.data(), text.size());
+    return std::string_view(data, text.size());
 }
 
-question text_parser::parse_single_block(std::string_view block, std::string_view file_name) const
+question_view text_parser::parse_block_view(std::string_view block, std::pmr::memory_resource* arena) const
 {
-    question q;
-    q.source_file = std::string(file_name);
+    question_view q;
 
     // 1. 查找答案分割点
     size_t split_index = block.size();
@@ -253,8 +468,8 @@ question text_parser::parse_single_block(std::string_view block, std::string_vie
     size_t pos_my = block.find("我的答案");
     
     size_t pos_cor = std::string_view::npos;
-    for (auto kw_sv : split_view(strategy_.answer_keywords, ',')) {
-        size_t pos = block.find(trim(kw_sv));
+    for (const auto& kw : answer_keywords_) {
+        size_t pos = block.find(kw);
         if (pos != std::string_view::npos && (pos_cor == std::string_view::npos || pos < pos_cor)) {
             pos_cor = pos;
         }
@@ -273,8 +488,7 @@ question text_parser::parse_single_block(std::string_view block, std::string_vie
     std::string_view real_answer_part;
     bool found_correct_kw = false;
 
-    for (auto kw_sv : split_view(strategy_.answer_keywords, ',')) {
-        auto kw = trim(kw_sv);
+    for (std::string_view kw : answer_keywords_) {
         size_t pos = block.find(kw);
         // 确保此关键词不是"我的答案" (My Answer) 的一部分
         // 例如，如果 kw 是 "答案"，我们需要检查它前面不是 "我的"
@@ -340,18 +554,17 @@ question text_parser::parse_single_block(std::string_view block, std::string_vie
     }
     
     // 2b. 内联答案提取 (如果没有找到关键词答案)
-    std::string patched_content; // If we modify content
-    bool content_modified = false;
-    std::string inline_answer_storage; // 用于存储内联提取的答案
+    // 题干默认直接引用源缓冲区；只有需要屏蔽内联答案时才拼接到线程内复用的缓冲区中
+    std::string_view content_str = content_part;
     
     if (answer_raw.empty()) {
         // 手动查找内联答案 (A), （A）, (AB), （AB）等
-        std::string search_str(content_part);
+        std::string_view search_str = content_part;
         
         // 查找所有匹配项，取最后一个
-        size_t best_start = std::string::npos;
-        size_t best_end = std::string::npos;
-        std::string best_answer;
+        size_t best_start = std::string_view::npos;
+        size_t best_end = std::string_view::npos;
+        std::string_view best_answer;
         
         for (size_t i = 0; i < search_str.size(); i++) {
             bool is_open = false;
@@ -382,14 +595,12 @@ question text_parser::parse_single_block(std::string_view block, std::string_vie
                 }
                 
                 // 检查是否是 A-Z
-                std::string letters;
                 size_t j = content_start;
-                while (j < search_str.size() && search_str[j] >= 'A' && search_str[j] <= 'Z') {
-                    letters += search_str[j];
-                    j++;
-                }
+                while (j < search_str.size() && search_str[j] >= 'A' && search_str[j] <= 'Z') j++;
                 
-                if (!letters.empty()) {
+                if (j > content_start) {
+                    std::string_view letters = search_str.substr(content_start, j - content_start);
+
                     // 跳过空白
                     while (j < search_str.size() && (search_str[j] == ' ' || search_str[j] == '\t')) j++;
                     
@@ -419,14 +630,17 @@ question text_parser::parse_single_block(std::string_view block, std::string_vie
             }
         }
         
-        if (best_start != std::string::npos) {
-            inline_answer_storage = best_answer;
-            answer_raw = std::string_view(inline_answer_storage); // 现在指向持久的存储
+        if (best_start != std::string_view::npos) {
+            answer_raw = best_answer; // 指向源缓冲区
             
-            // 在内容中屏蔽答案
-            patched_content = search_str;
-            patched_content.replace(best_start, best_end - best_start, "( )");
-            content_modified = true;
+            // 在内容中屏蔽答案: 改写后的题干放在内存区中
+            std::string_view head = search_str.substr(0, best_start);
+            std::string_view tail = search_str.substr(best_end);
+            char* patched = static_cast<char*>(arena->allocate(head.size() + 3 + tail.size(), 1));
+            std::memcpy(patched, head.data(), head.size());
+            std::memcpy(patched + head.size(), "( )", 3);
+            std::memcpy(patched + head.size() + 3, tail.data(), tail.size());
+            content_str = std::string_view(patched, head.size() + 3 + tail.size());
         }
     }
 
@@ -434,13 +648,6 @@ question text_parser::parse_single_block(std::string_view block, std::string_vie
     q.type = detect_type(content_part, answer_raw);
 
     // 4. 清理内容 (移除 "1. " 或 "1．" 或 "1、" 和可选的 "[单选题]")
-    std::string content_str;
-    if (content_modified) {
-        content_str = patched_content;
-    } else {
-        content_str = std::string(content_part);
-    }
-    
     // 手动清理题号前缀，支持 UTF-8 全角标点
     {
         size_t i = 0;
@@ -506,9 +713,9 @@ question text_parser::parse_single_block(std::string_view block, std::string_vie
                         }
                         j++;
                     }
-                    if (close_pos != std::string::npos) {
+                    if (close_pos != std::string_view::npos) {
                         // 检查括号内是否包含题型关键词
-                        std::string_view inside = std::string_view(content_str).substr(i, close_pos - i);
+                        std::string_view inside = content_str.substr(i, close_pos - i);
                         if (inside.find("单选") != std::string_view::npos ||
                             inside.find("多选") != std::string_view::npos ||
                             inside.find("判断") != std::string_view::npos ||
@@ -532,67 +739,60 @@ question text_parser::parse_single_block(std::string_view block, std::string_vie
     
     // 5. 解析选项
     if (q.type == question_type::single || q.type == question_type::multi || q.type == question_type::judge) {
-        std::vector<std::pair<std::string, size_t>> opt_indices;
-        
         // 自定义选项查找，支持 UTF-8 全角标点
-        // 查找模式: 换行或行首 + 可选空白 + A-Z + 点号(半角/全角/顿号)
-        size_t pos = 0;
-        while (pos < content_str.size()) {
-            // 跳到行首或换行后
-            bool at_line_start = (pos == 0);
-            if (!at_line_start && pos > 0) {
-                // 检查前一个字符是否是换行
-                if (content_str[pos-1] == '\n') at_line_start = true;
-            }
-            
-            if (at_line_start) {
+        // 查找模式: 行首 + 可选空白 + A-Z + 点号(半角/全角/顿号)
+        // 返回 pos 及之后第一个选项的起点 (字母位置)，pos 必须位于行首
+        auto find_option = [&content_str](size_t pos) -> size_t {
+            while (pos < content_str.size()) {
                 // 跳过空白
                 size_t start = pos;
                 while (start < content_str.size() && (content_str[start] == ' ' || content_str[start] == '\t')) start++;
                 
-                // 检查是否是 A-Z
+                // 检查是否是 A-Z，且后面是点号
                 if (start < content_str.size() && content_str[start] >= 'A' && content_str[start] <= 'Z') {
-                    char opt_letter = content_str[start];
                     size_t after_letter = start + 1;
-                    
-                    bool is_option = false;
-                    // 检查后面是否是点号
                     if (after_letter < content_str.size()) {
-                        if (content_str[after_letter] == '.') {
-                            is_option = true;
-                        } else if (after_letter + 2 < content_str.size()) {
+                        if (content_str[after_letter] == '.') return start;
+                        if (after_letter + 2 < content_str.size()) {
                             unsigned char c1 = static_cast<unsigned char>(content_str[after_letter]);
                             unsigned char c2 = static_cast<unsigned char>(content_str[after_letter+1]);
                             unsigned char c3 = static_cast<unsigned char>(content_str[after_letter+2]);
                             // 全角点 ．(U+FF0E) = EF BC 8E
-                            if (c1 == 0xEF && c2 == 0xBC && c3 == 0x8E) is_option = true;
+                            if (c1 == 0xEF && c2 == 0xBC && c3 == 0x8E) return start;
                             // 中文顿号 、(U+3001) = E3 80 81
-                            if (c1 == 0xE3 && c2 == 0x80 && c3 == 0x81) is_option = true;
+                            if (c1 == 0xE3 && c2 == 0x80 && c3 == 0x81) return start;
                         }
                     }
-                    
-                    if (is_option) {
-                        opt_indices.push_back({ std::string(1, opt_letter), start });
-                    }
                 }
+                
+                // 移动到下一个换行符后
+                size_t next_nl = content_str.find('\n', pos);
+                if (next_nl == std::string_view::npos) break;
+                pos = next_nl + 1;
             }
+            return std::string_view::npos;
+        };
+        // 从选项起点所在行的下一行继续查找
+        auto find_next_option = [&](size_t start) -> size_t {
+            size_t next_nl = content_str.find('\n', start);
+            return next_nl == std::string_view::npos ? std::string_view::npos : find_option(next_nl + 1);
+        };
+
+        size_t first_opt_pos = find_option(0);
+
+        if (first_opt_pos != std::string_view::npos) {
+            q.content = trim(content_str.substr(0, first_opt_pos));
+
+            size_t option_count = 0;
+            for (size_t start = first_opt_pos; start != std::string_view::npos; start = find_next_option(start)) option_count++;
+            auto* options = static_cast<option_view*>(arena->allocate(option_count * sizeof(option_view), alignof(option_view)));
+            size_t n = 0;
             
-            // 移动到下一个换行符后
-            size_t next_nl = content_str.find('\n', pos);
-            if (next_nl == std::string::npos) break;
-            pos = next_nl + 1;
-        }
-        
-        size_t first_opt_pos = opt_indices.empty() ? std::string::npos : opt_indices[0].second;
-
-        if (first_opt_pos != std::string::npos) {
-            q.content = trim(std::string_view(content_str).substr(0, first_opt_pos));
-            
-            for (size_t i = 0; i < opt_indices.size(); ++i) {
-                size_t start = opt_indices[i].second;
-                size_t next_start = (i == opt_indices.size() - 1) ? content_str.length() : opt_indices[i+1].second;
+            for (size_t start = first_opt_pos; start != std::string_view::npos; ) {
+                size_t next_start = find_next_option(start);
                 
-                std::string_view raw_opt = std::string_view(content_str).substr(start, next_start - start);
+                std::string_view raw_opt = content_str.substr(start, next_start == std::string_view::npos ? std::string_view::npos : next_start - start);
+                char opt_letter = raw_opt[0];
                 
                 // 跳过 "A." 或 "A．" 或 "A、" 部分
                 size_t skip = 1; // 跳过字母
@@ -604,41 +804,69 @@ question text_parser::parse_single_block(std::string_view block, std::string_vie
                         if (c1 == 0xEF || c1 == 0xE3) skip += 3; // 跳过 UTF-8 多字节标点
                     }
                 }
-                raw_opt = raw_opt.substr(skip);
-                
-                q.options.push_back(opt_indices[i].first + ". " + std::string(trim(raw_opt)));
+                new (options + n++) option_view{ opt_letter, trim(raw_opt.substr(skip)) };
+
+                start = next_start;
             }
+            q.options = std::span<const option_view>(options, n);
         } else {
             q.content = trim(content_str);
         }
 
         // 判断题的回退 (如果解析不到选项，例如只有 "True/False" 文本而不是 A/B)
         if (q.type == question_type::judge && q.options.empty()) {
-             q.options = { "A. 对", "B. 错" };
+            static constexpr option_view judge_options[] = { { 'A', "对" }, { 'B', "错" } };
+            q.options = judge_options;
         }
     } else {
         q.content = trim(content_str);
     }
 
     // 6. 最终确定答案
+    // 规范化结果通常就是原文的前缀 (例如 "A"、"ACD")，此时直接引用原文，否则存入内存区
     if (!answer_raw.empty()) {
+        thread_local std::string normalized;
+        normalized.clear();
+
         if (q.type == question_type::judge) {
-            if (is_judge_true(answer_raw)) q.correct_answer = "A";
-            else if (is_judge_false(answer_raw)) q.correct_answer = "B";
-            else q.correct_answer = std::string(answer_raw);
+            uint32_t judge = keywords_.scan(answer_raw, kw_judge_mask);
+            if (judge & kw_judge_true) q.correct_answer = "A";
+            else if (judge & kw_judge_false) q.correct_answer = "B";
+            else q.correct_answer = answer_raw;
         } else if (q.type == question_type::fill) {
-             static const std::regex re_idx(R"(\(\d+\)\s*)");
-             q.correct_answer = std::regex_replace(std::string(answer_raw), re_idx, "");
+             // 去掉空序号 "(1) "、"(2)" 等 (等价于正则 \(\d+\)\s* 替换为空)
+             size_t i = 0;
+             while (i < answer_raw.size()) {
+                 if (answer_raw[i] == '(') {
+                     size_t j = i + 1;
+                     while (j < answer_raw.size() && answer_raw[j] >= '0' && answer_raw[j] <= '9') j++;
+                     if (j > i + 1 && j < answer_raw.size() && answer_raw[j] == ')') {
+                         j++;
+                         while (j < answer_raw.size() && (answer_raw[j] == ' ' || (answer_raw[j] >= '\t' && answer_raw[j] <= '\r'))) j++;
+                         i = j;
+                         continue;
+                     }
+                 }
+                 normalized += answer_raw[i++];
+             }
         } else {
              // 过滤 A-Z
-             std::string final_ans;
              for (char c : answer_raw) {
-                 if (c >= 'A' && c <= 'Z') final_ans += c;
+                 if (c >= 'A' && c <= 'Z') normalized += c;
                  if (c == ';' || (unsigned char)c > 127) break;
              }
-             q.correct_answer = final_ans;
         }
+
+        if (q.type != question_type::judge) {
+            q.correct_answer = answer_raw.starts_with(normalized) ? answer_raw.substr(0, normalized.size()) : store(arena, normalized);
+        }
+    }
+
+    // 选择题的答案同时保存为位掩码，判分和统计不再比较字符串
+    if (q.type != question_type::fill) {
+        q.answer_mask = make_answer_mask(q.correct_answer);
     }
 
+    q.update_id();
     return q;
 }
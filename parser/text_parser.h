@@ -1,11 +1,16 @@
 ﻿#pragma once
 
 #include "../question.h"
+#include "../question_view.h"
 #include "parser_strategy.h"
+#include "keyword_matcher.h"
+#include "pattern_dfa.h"
 #include <string_view>
 #include <vector>
 #include <regex>
 #include <optional>
+#include <string>
+#include <functional>
 
 // 文本解析器
 class text_parser
@@ -14,15 +19,72 @@ public:
     explicit text_parser(parser_strategy strategy = parser_strategy::get_default());
 
     // 核心接口: 解析内存块 -> 题目列表
-    [[nodiscard]] std::vector<question> parse(std::string_view content, std::string_view file_name = "") const;
+    // 超过 parallel_threshold 的内容分两阶段并行解析 (先找题目块边界，再分片解析各块)，结果与串行解析完全一致
+    // 传入 arenas 时题目字符串分配在其提供的内存区中 (每个分片一个)，否则使用堆分配
+    // file_id 写入每道题 (来源文件在题库文件表中的下标)，block_offset 为题目块在 content 中的字节偏移
+    // max_workers 限制文件内部的并行线程数 (多个文件同时解析时由调用方分摊 CPU 核心)，0 表示不超过 CPU 核心数
+    [[nodiscard]] std::vector<question> parse(std::string_view content, uint32_t file_id = 0, const arena_source& arenas = {},
+                                              size_t max_workers = 0) const;
+
+    // 只读扫描: 题目以视图形式追加到 out，字符串指向 content (调用方需保证 content 在 out 销毁前有效)
+    // 用于统计等不需要拥有字符串的场景；与 parse() 得到的题目一一对应
+    void parse_views(std::string_view content, uint32_t file_id, question_view_list& out, size_t max_workers = 0) const;
+
+    static constexpr size_t parallel_threshold = 4 * 1024 * 1024;
+    static constexpr size_t min_blocks_per_shard = 256;   // 每个线程至少分到的题目块数
 
     const parser_strategy& strategy() const { return strategy_; }
 
+    // 快速匹配不支持、退回 std::regex 的垃圾行正则 (逐行匹配较慢)
+    const std::vector<std::string>& unsupported_patterns() const { return unsupported_patterns_; }
+
+    // 流式解析: 分块喂入文件内容，题目逐个交给 sink
+    // 只缓存当前未结束的题目块和不完整的行，峰值内存为 O(块大小 + 最大题目块)，与文件大小无关
+    // 产出的题目与对整个文件调用 parse() 完全一致 (block_offset 为相对于全部已喂入数据的偏移)
+    class stream
+    {
+    public:
+        using sink_type = std::function<void(question&&)>;
+
+        // resource: 题目字符串使用的内存区 (只在调用 feed/finish 的线程中使用)
+        stream(const text_parser& parser, uint32_t file_id, sink_type sink,
+               std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+        // 追加一块数据 (可以在任意字节处切分)
+        void feed(std::string_view chunk);
+
+        // 数据结束，刷新最后一个题目块
+        void finish();
+
+    private:
+        void scan(bool at_eof);
+        void emit_block(size_t end);
+
+        const text_parser& parser_;
+        uint32_t file_id_;
+        sink_type sink_;
+        std::pmr::memory_resource* resource_;
+
+        std::string buffer_;        // 未处理的数据: 从当前题目块开头 (或下一行) 开始
+        size_t scanned_ = 0;        // buffer_ 中已逐行检查到的位置
+        size_t block_begin_ = 0;    // 当前题目块在 buffer_ 中的起点
+        bool in_block_ = false;     // 是否已遇到第一个题目开头
+        uint64_t dropped_ = 0;      // 已从 buffer_ 头部丢弃的字节数 (buffer_[0] 在整个输入中的偏移)
+    };
+
 private:
     parser_strategy strategy_;
 
-    // 编译的正则表达式用于复杂匹配 (垃圾行过滤)
+    // 垃圾行正则: 合并成一个 DFA；DFA 不支持的模式单独编译为 std::regex
+    pattern_dfa garbage_dfa_;
     std::vector<std::regex> re_garbage_list_;
+    std::vector<std::string> unsupported_patterns_;
+
+    // 题型关键词、判断题取值和纯文本垃圾行关键词编译成的多模式自动机
+    keyword_matcher keywords_;
+
+    // 答案关键词 (已拆分并去除空白，按策略中的顺序)
+    std::vector<std::string> answer_keywords_;
     
     // 内部编译
     void compile_patterns();
@@ -32,6 +94,13 @@ private:
     std::string_view trim(std::string_view sv) const;
     bool is_garbage_line(std::string_view line) const;
     bool is_question_start(std::string_view line) const;
+    bool starts_block(std::string_view line) const;
+
+    // 返回起点位于 [begin, end) 内的题目块起始偏移 (begin 必须位于行首)
+    std::vector<size_t> find_block_starts(std::string_view content, size_t begin, size_t end) const;
+    // 全部题目块的起始偏移 (worker_count > 1 时按行边界分段并行扫描)
+    std::vector<size_t> find_all_block_starts(std::string_view content, size_t worker_count) const;
+    static size_t worker_count_for(size_t content_size, size_t max_workers = 0);
     
     // 解析逻辑
     struct block_info {
@@ -39,11 +108,10 @@ private:
         size_t start_line; // 可选的调试信息
     };
     
-    question parse_single_block(std::string_view block, std::string_view file_name) const;
+    question parse_single_block(std::string_view block, uint32_t file_id, uint64_t block_offset, std::pmr::memory_resource* resource) const;
+    // 解析一个题目块为视图 (file_id 和 block_offset 由调用方填写)；需要改写的文本和选项数组分配在 arena 中
+    question_view parse_block_view(std::string_view block, std::pmr::memory_resource* arena) const;
 
     // 检测辅助函数
-    bool contains_keyword(std::string_view text, std::string_view keywords_csv) const;
     question_type detect_type(std::string_view block, std::string_view answer_raw) const;
-    bool is_judge_true(std::string_view answer) const;
-    bool is_judge_false(std::string_view answer) const;
 };
@@ -16,7 +16,24 @@ SOURCES += \
     pages/ExamConfigPage.cpp \
     pages/ParserStrategyPage.cpp \
     pages/PracticeStrategyPage.cpp \
-    pages/SettingsPage.cpp
+    pages/SettingsPage.cpp \
+    bank_loader.cpp \
+    parser/keyword_matcher.cpp \
+    parser/pattern_dfa.cpp \
+    parse_cache.cpp \
+    bank_load_task.cpp \
+    parser/line_splitter.cpp \
+    encoding_utils.cpp \
+    question_bank.cpp \
+    question_view.cpp \
+    bank_index.cpp \
+    selection_plan.cpp \
+    dedup_set.cpp \
+    mistake_journal.cpp \
+    mistake_index.cpp \
+    history_log.cpp \
+    io_writer.cpp \
+    gb18030_table.cpp
 
 HEADERS += \
     MainWindow.h \
@@ -30,7 +47,24 @@ HEADERS += \
     pages/HistoryPage.h \
     pages/ExamConfigPage.h \
     pages/ParserStrategyPage.h \
-    pages/PracticeStrategyPage.h
+    pages/PracticeStrategyPage.h \
+    bank_loader.h \
+    parser/keyword_matcher.h \
+    parser/pattern_dfa.h \
+    parse_cache.h \
+    bank_load_task.h \
+    parser/line_splitter.h \
+    encoding_utils.h \
+    question_bank.h \
+    question_view.h \
+    bank_index.h \
+    selection_plan.h \
+    dedup_set.h \
+    mistake_journal.h \
+    mistake_index.h \
+    history_log.h \
+    io_writer.h \
+    gb18030_table.h
 
 FORMS += \
     MainWindow.ui \
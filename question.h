@@ -1,4 +1,11 @@
 ﻿#pragma once
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory_resource>
+#include <span>
 #include <variant>
 #include <vector>
 #include <format>
@@ -25,9 +32,9 @@ enum class answer_state
 
 // FNV-1a 64-bit Hash 算法
 // 特点：极快，确定性，纯C++，无依赖，适合作为 ID
-constexpr size_t stable_hash(std::string_view s)
+// hash 传入上一段的结果即可增量计算: stable_hash(b, stable_hash(a)) == stable_hash(a + b)
+constexpr size_t stable_hash(std::string_view s, size_t hash = 14695981039346656037ull) // FNV 偏移基准
 {
-    size_t hash = 14695981039346656037ull; // FNV 偏移基准
     size_t prime = 1099511628211ull;       // FNV 质数
 
     for(unsigned char c : s)
@@ -38,33 +45,234 @@ constexpr size_t stable_hash(std::string_view s)
     return hash;
 }
 
+// 选择题 (单选/多选/判断) 答案的位掩码: 第 i 位表示选项 'A' + i
+// 判分、高亮、全选判断和答案分布统计都直接做整数运算
+constexpr uint32_t option_bit(char letter)
+{
+    return letter >= 'A' && letter <= 'Z' ? 1u << (letter - 'A') : 0;
+}
+
+// 由字母组成的答案 (例如 "ACD") 转换为位掩码；含其他字符 (无法识别的判断题答案等) 时返回 0
+constexpr uint32_t make_answer_mask(std::string_view letters)
+{
+    uint32_t mask = 0;
+    for(char c : letters)
+    {
+        uint32_t bit = option_bit(c);
+        if(bit == 0) return 0;
+        mask |= bit;
+    }
+    return mask;
+}
+
+// 位掩码转换回字母 (按字母顺序)，用于显示
+inline std::string answer_letters(uint32_t mask)
+{
+    std::string letters;
+    for(; mask != 0; mask &= mask - 1)
+    {
+        letters += static_cast<char>('A' + std::countr_zero(mask));
+    }
+    return letters;
+}
+
+// 题目的来源文件 (每个题库一张表，题目只保存表中的下标)
+struct source_file
+{
+    std::string path;           // 完整路径
+    std::string display_name;   // 显示用的文件名 (已解码百分号编码并去掉路径)
+    size_t duplicates = 0;      // 加载时去重丢弃的题目数
+};
+
+// 题目字符串使用的内存区来源: 每次调用返回一个新的内存区，只供调用它的线程使用 (单调分配器不是线程安全的)
+// size_hint 为将要解析的文本字节数，用于确定首块大小；为空时使用默认的堆分配
+using arena_source = std::function<std::pmr::memory_resource * (size_t size_hint)>;
+
+// 选项的只读视图: 字母和去掉 "A." 前缀后的文本
+struct option_view
+{
+    char letter = 'A';
+    std::string_view text;   // 已去除首尾空白 (题目视图中可能含 \r)
+};
+
+// 一道题的全部选项，扁平存放在一个连续缓冲区中:
+// [字母 x n][结束偏移 uint32 x n][选项文本首尾相接]
+// 字母和文本分开保存，显示、哈希和排序都直接使用 option_view，不需要分配也不需要再拆 "A. " 前缀
+class option_list
+{
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+
+    class iterator
+    {
+    public:
+        using value_type = option_view;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+        iterator(const option_list * list, size_t index) : list_(list), index_(index) {}
+
+        option_view operator*() const { return (*list_)[index_]; }
+        iterator & operator++() { ++index_; return *this; }
+        iterator operator++(int) { iterator old = *this; ++index_; return old; }
+        bool operator==(const iterator & other) const { return index_ == other.index_; }
+
+    private:
+        const option_list * list_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    option_list() = default;
+    explicit option_list(const allocator_type & alloc) : buffer_(alloc) {}
+    option_list(const option_list &) = default;
+    option_list(option_list &&) = default;
+    option_list(const option_list & other, const allocator_type & alloc) : buffer_(other.buffer_, alloc), count_(other.count_) {}
+    option_list & operator=(const option_list &) = default;
+    option_list & operator=(option_list &&) = default;
+
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+
+    option_view operator[](size_t i) const
+    {
+        uint32_t begin = i == 0 ? static_cast<uint32_t>(table_bytes()) : end_of(i - 1);
+        return { buffer_[i], std::string_view(buffer_).substr(begin, end_of(i) - begin) };
+    }
+
+    iterator begin() const { return iterator(this, 0); }
+    iterator end() const { return iterator(this, count_); }
+
+    // 替换全部选项 (一次分配；文本中的 \r 被去掉)
+    void assign(std::span<const option_view> options)
+    {
+        size_t text_bytes = 0;
+        for (const auto & opt : options) text_bytes += opt.text.size() - static_cast<size_t>(std::ranges::count(opt.text, '\r'));
+
+        count_ = static_cast<uint32_t>(options.size());
+        buffer_.resize(table_bytes() + text_bytes);
+
+        char * text_out = buffer_.data() + table_bytes();
+        for (size_t i = 0; i < options.size(); ++i)
+        {
+            buffer_[i] = options[i].letter;
+            text_out = std::ranges::remove_copy(options[i].text, text_out, '\r').out;
+            auto end = static_cast<uint32_t>(text_out - buffer_.data());
+            std::memcpy(buffer_.data() + count_ + i * sizeof(uint32_t), &end, sizeof(end));
+        }
+    }
+
+    // 原始缓冲区 (用于序列化)
+    std::string_view buffer() const { return buffer_; }
+
+    // 从序列化的缓冲区恢复；偏移表不合法时返回 false 并清空
+    bool assign_buffer(size_t count, std::string_view buffer)
+    {
+        count_ = static_cast<uint32_t>(count);
+        buffer_.assign(buffer);
+
+        bool valid = count == 0 ? buffer.empty() : buffer.size() >= table_bytes();
+        for (size_t i = 0, begin = table_bytes(); valid && i < count; ++i)
+        {
+            uint32_t end = end_of(i);
+            valid = end >= begin && end <= buffer.size() && (i + 1 < count || end == buffer.size());
+            begin = end;
+        }
+        if (!valid)
+        {
+            count_ = 0;
+            buffer_.clear();
+        }
+        return valid;
+    }
+
+    bool operator==(const option_list & other) const = default;
+
+private:
+    size_t table_bytes() const { return count_ * (1 + sizeof(uint32_t)); }
+
+    uint32_t end_of(size_t i) const
+    {
+        uint32_t end;
+        std::memcpy(&end, buffer_.data() + count_ + i * sizeof(uint32_t), sizeof(end));
+        return end;
+    }
+
+    std::pmr::string buffer_;
+    uint32_t count_ = 0;
+};
+
+// 字符串成员使用 pmr 分配器: 整库加载时全部分配在 question_bank 的内存区里，题库释放时一次性归还
+// 移动保留原分配器；拷贝得到使用默认堆分配的独立副本 (例如存入错题本)
 class question
 {
 public:
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+
+    question() = default;
+    explicit question(const allocator_type & alloc)
+        : content(alloc), options(alloc), correct_answer(alloc)
+    {
+    }
+    question(const question &) = default;
+    question(question &&) = default;
+    question(const question & other, const allocator_type & alloc)
+        : type(other.type), file_id(other.file_id), block_offset(other.block_offset),
+          content(other.content, alloc), options(other.options, alloc), correct_answer(other.correct_answer, alloc),
+          answer_mask(other.answer_mask), id(other.id)
+    {
+    }
+    question & operator=(const question &) = default;
+    question & operator=(question &&) = default;
 
     question_type type = question_type::unknown;
-    std::string content;                 // 题目内容 (UTF-8 编码)
-    std::vector<std::string> options;    // 选项 A, B, C, D...
-    std::string source_file;             // 来源文件名
-    std::string correct_answer;          // 正确答案
+    uint32_t file_id = 0;                         // 来源文件在所属题库文件表中的下标
+    uint64_t block_offset = 0;                    // 题目块在来源文本中的字节偏移 (去掉 BOM、转码为 UTF-8 之后)
+    std::pmr::string content;                     // 题目内容 (UTF-8 编码)
+    option_list options;                          // 选项 A, B, C, D... (字母和文本分开保存)
+    std::pmr::string correct_answer;              // 正确答案
+    uint32_t answer_mask = 0;                     // 选择题正确答案的位掩码 (解析时由 correct_answer 生成，填空题为 0)
+
+    size_t id = 0;                                // 稳定 ID (解析时由 update_id() 计算一次)
 
     size_t get_id() const
     {
-        // 组合 Content 和排序后的 Options 生成稳定的 ID
-        // 选项先排序，确保选项顺序不同但内容相同的题目生成相同的 ID
-        std::string combined = content;
-        
-        // 复制选项并排序
-        std::vector<std::string> sorted_options = options;
-        std::ranges::sort(sorted_options);
-        
-        // 拼接所有选项
-        for (const auto& opt : sorted_options)
+        return id;
+    }
+
+    // 组合 Content 和排序后的 Options 生成稳定的 ID
+    // 选项先排序，确保选项顺序不同但内容相同的题目生成相同的 ID
+    // 等价于 stable_hash(content + "|A. " + text1 + "|B. " + text2 ...)，但逐段增量计算，不拼接临时字符串
+    void update_id()
+    {
+        // 选项通常不多，排序在栈上的视图数组中完成
+        // 按 (字母, 文本) 排序，与按 "A. 文本" 整串排序的结果相同 (string_view 按无符号字节比较)
+        std::array<option_view, 16> small;
+        std::vector<option_view> large;
+        std::span<option_view> sorted_options;
+        if(options.size() <= small.size())
+        {
+            sorted_options = std::span(small.data(), options.size());
+        }
+        else
+        {
+            large.resize(options.size());
+            sorted_options = large;
+        }
+        std::ranges::copy(options, sorted_options.begin());
+        std::ranges::sort(sorted_options, {}, [](const option_view & opt)
+            {
+                return std::pair(static_cast<unsigned char>(opt.letter), opt.text);
+            });
+
+        size_t hash = stable_hash(content);
+        for (const auto & opt : sorted_options)
         {
-            combined += "|" + opt;  // 使用分隔符避免歧义
+            hash = stable_hash("|", hash);  // 使用分隔符避免歧义
+            hash = stable_hash(std::string_view(&opt.letter, 1), hash);
+            hash = stable_hash(". ", hash);
+            hash = stable_hash(opt.text, hash);
         }
-        
-        return stable_hash(combined);
+        id = hash;
     }
 
     bool operator==(const question & other) const = default;
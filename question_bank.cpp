@@ -0,0 +1,141 @@
+﻿#include "question_bank.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+namespace
+{
+    // 单调分配的内存区: 按固定大小的块向上游申请，当前块放不下时开新块，单独释放为空操作
+    // 与 std::pmr::monotonic_buffer_resource 不同，块大小不倍增，每个内存区最多浪费一个块的尾部
+    class bump_arena : public std::pmr::memory_resource
+    {
+    public:
+        bump_arena(size_t chunk_size, std::pmr::memory_resource * upstream)
+            : chunk_size_(chunk_size), upstream_(upstream)
+        {
+        }
+
+        ~bump_arena() override
+        {
+            for(const auto & chunk : chunks_) upstream_->deallocate(chunk.data, chunk.size, alignof(std::max_align_t));
+        }
+
+    private:
+        struct chunk
+        {
+            void * data;
+            size_t size;
+        };
+
+        void * do_allocate(size_t bytes, size_t alignment) override
+        {
+            void * p = cur_;
+            size_t space = static_cast<size_t>(end_ - cur_);
+            if(std::align(alignment, bytes, p, space))
+            {
+                cur_ = static_cast<char *>(p) + bytes;
+                return p;
+            }
+
+            // 较大的分配单独占一块，不丢弃当前块的剩余空间
+            size_t size = bytes + alignment;
+            bool dedicated = size > chunk_size_ / 4;
+            if(!dedicated) size = chunk_size_;
+
+            void * data = upstream_->allocate(size, alignof(std::max_align_t));
+            chunks_.push_back({ data, size });
+
+            p = data;
+            space = size;
+            std::align(alignment, bytes, p, space);
+            if(!dedicated)
+            {
+                cur_ = static_cast<char *>(p) + bytes;
+                end_ = static_cast<char *>(data) + size;
+            }
+            return p;
+        }
+
+        void do_deallocate(void *, size_t, size_t) override
+        {
+            // 内存随整个内存区一起释放
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource & other) const noexcept override
+        {
+            return this == &other;
+        }
+
+        size_t chunk_size_;
+        std::pmr::memory_resource * upstream_;
+        std::vector<chunk> chunks_;
+        char * cur_ = nullptr;
+        char * end_ = nullptr;
+    };
+}
+
+// 所有内存区的上游: 统计向系统申请的字节数，并持有各内存区
+struct question_bank::arena_pool : std::pmr::memory_resource
+{
+    std::atomic<size_t> bytes{ 0 };
+    std::mutex mutex;
+    std::vector<std::unique_ptr<bump_arena>> arenas;
+
+    ~arena_pool() override
+    {
+        // 在析构函数体内释放，内存区归还内存时本对象仍然完整
+        arenas.clear();
+    }
+
+    void * do_allocate(size_t bytes_needed, size_t alignment) override
+    {
+        bytes += bytes_needed;
+        return std::pmr::new_delete_resource()->allocate(bytes_needed, alignment);
+    }
+
+    void do_deallocate(void * p, size_t bytes_used, size_t alignment) override
+    {
+        bytes -= bytes_used;
+        std::pmr::new_delete_resource()->deallocate(p, bytes_used, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource & other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+question_bank::question_bank()
+    : pool_(std::make_unique<arena_pool>())
+{
+}
+
+question_bank::~question_bank() = default;
+
+question_bank::question_bank(question_bank && other) noexcept = default;
+
+question_bank & question_bank::operator=(question_bank && other) noexcept
+{
+    // 先释放旧题目，再释放它们所在的内存区
+    questions_ = std::move(other.questions_);
+    files_ = std::move(other.files_);
+    deduplicated_ = other.deduplicated_;
+    pool_ = std::move(other.pool_);
+    return *this;
+}
+
+std::pmr::memory_resource * question_bank::new_arena(size_t size_hint)
+{
+    // 块大小随文本大小取 1/8，限制在 [4 KB, 1 MB]: 小文件不会因整块预留而浪费，大文件的块数也不会过多
+    size_t chunk_size = std::clamp<size_t>(size_hint / 8, 4 * 1024, 1024 * 1024);
+
+    std::lock_guard lock(pool_->mutex);
+    return pool_->arenas.emplace_back(std::make_unique<bump_arena>(chunk_size, pool_.get())).get();
+}
+
+size_t question_bank::arena_bytes() const
+{
+    return pool_ ? pool_->bytes.load() : 0;
+}
@@ -0,0 +1,52 @@
+﻿#pragma once
+
+#include "question.h"
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+// 整库加载的题目容器: 题目字符串全部分配在题库自带的单调内存区里
+// 解析时不再产生成千上万个独立的堆块，题库销毁时内存区整体释放，避免反复换题库造成堆碎片
+// 从题库中移出的题目仍引用这些内存区，必须先于题库销毁
+class question_bank
+{
+public:
+    question_bank();
+    ~question_bank();
+
+    question_bank(question_bank && other) noexcept;
+    question_bank & operator=(question_bank && other) noexcept;
+
+    // 新建一个内存区 (线程安全)，内存区归题库所有
+    // 内存区按块向系统申请，块大小由 size_hint (将要解析的文本字节数) 决定
+    std::pmr::memory_resource * new_arena(size_t size_hint = 0);
+
+    // 可直接传给解析器的 arena_source
+    arena_source arenas() { return [this](size_t size_hint) { return new_arena(size_hint); }; }
+
+    std::vector<question> & questions() { return questions_; }
+    const std::vector<question> & questions() const { return questions_; }
+
+    size_t size() const { return questions_.size(); }
+    bool empty() const { return questions_.empty(); }
+
+    // 来源文件表: question::file_id 是表中的下标
+    std::vector<source_file> & files() { return files_; }
+    const std::vector<source_file> & files() const { return files_; }
+    const source_file & file_of(const question & q) const { return files_[q.file_id]; }
+
+    // 加载时是否已跨文件去重 (题目 ID 互不相同)
+    bool deduplicated() const { return deduplicated_; }
+    void set_deduplicated(bool value) { deduplicated_ = value; }
+
+    // 内存区向系统申请的总字节数
+    size_t arena_bytes() const;
+
+private:
+    struct arena_pool;
+
+    std::unique_ptr<arena_pool> pool_;   // 先声明后销毁: 题目析构时内存区仍然有效
+    std::vector<source_file> files_;
+    std::vector<question> questions_;
+    bool deduplicated_ = false;
+};
@@ -0,0 +1,140 @@
+﻿#include "question_view.h"
+
+#include <algorithm>
+#include <array>
+
+namespace
+{
+    // 跳过 \r 计算哈希，等价于对 erase_cr 之后的文本计算
+    size_t hash_without_cr(std::string_view s, size_t hash)
+    {
+        for(size_t pos = 0; pos < s.size(); )
+        {
+            size_t cr = s.find('\r', pos);
+            if(cr == std::string_view::npos) cr = s.size();
+            hash = stable_hash(s.substr(pos, cr - pos), hash);
+            pos = cr + 1;
+        }
+        return hash;
+    }
+
+    // 追加文本并去掉 \r
+    void append_without_cr(std::pmr::string & out, std::string_view s)
+    {
+        for(char c : s)
+        {
+            if(c != '\r') out += c;
+        }
+    }
+
+    // 按 "A. 文本" 的字节序比较两个选项 (与 std::string 的比较一致: 无符号字节，跳过 \r)
+    bool option_less(const option_view & a, const option_view & b)
+    {
+        if(a.letter != b.letter) return static_cast<unsigned char>(a.letter) < static_cast<unsigned char>(b.letter);
+
+        auto not_cr = [](char c) { return c != '\r'; };
+        auto as_byte = [](char c) { return static_cast<unsigned char>(c); };
+        return std::ranges::lexicographical_compare(a.text | std::views::filter(not_cr) | std::views::transform(as_byte),
+                                                    b.text | std::views::filter(not_cr) | std::views::transform(as_byte));
+    }
+}
+
+void question_view::update_id()
+{
+    std::array<option_view, 16> small;
+    std::vector<option_view> large;
+    std::span<option_view> sorted_options;
+    if(options.size() <= small.size())
+    {
+        sorted_options = std::span(small.data(), options.size());
+    }
+    else
+    {
+        large.resize(options.size());
+        sorted_options = large;
+    }
+    std::ranges::copy(options, sorted_options.begin());
+    std::ranges::sort(sorted_options, option_less);
+
+    size_t hash = hash_without_cr(content, stable_hash(""));
+    for(const auto & opt : sorted_options)
+    {
+        hash = stable_hash("|", hash);
+        hash = stable_hash(std::string_view(&opt.letter, 1), hash);
+        hash = stable_hash(". ", hash);
+        hash = hash_without_cr(opt.text, hash);
+    }
+    id = hash;
+}
+
+question question_view::materialize(const question::allocator_type & alloc) const
+{
+    question q(alloc);
+    q.type = type;
+
+    q.content.reserve(content.size());
+    append_without_cr(q.content, content);
+
+    q.options.assign(options);
+
+    q.file_id = file_id;
+    q.block_offset = block_offset;
+    append_without_cr(q.correct_answer, correct_answer);
+    q.answer_mask = answer_mask;
+    q.id = id;
+    return q;
+}
+
+std::pmr::memory_resource * question_view_list::new_arena()
+{
+    return arenas_.emplace_back(std::make_unique<std::pmr::monotonic_buffer_resource>()).get();
+}
+
+uint32_t question_view_list::add_file(source_file file)
+{
+    files_.push_back(std::move(file));
+    return static_cast<uint32_t>(files_.size() - 1);
+}
+
+void question_view_list::keep_alive(std::shared_ptr<const void> owner)
+{
+    owners_.push_back(std::move(owner));
+}
+
+void question_view_list::append(question_view_list && other)
+{
+    auto file_base = static_cast<uint32_t>(files_.size());
+    size_t first = views_.size();
+
+    owners_.insert(owners_.end(), std::make_move_iterator(other.owners_.begin()), std::make_move_iterator(other.owners_.end()));
+    arenas_.insert(arenas_.end(), std::make_move_iterator(other.arenas_.begin()), std::make_move_iterator(other.arenas_.end()));
+    files_.insert(files_.end(), std::make_move_iterator(other.files_.begin()), std::make_move_iterator(other.files_.end()));
+    views_.insert(views_.end(), other.views_.begin(), other.views_.end());
+    for(size_t i = first; i < views_.size(); ++i) views_[i].file_id += file_base;
+
+    other.owners_.clear();
+    other.arenas_.clear();
+    other.files_.clear();
+    other.views_.clear();
+}
+
+question_bank question_view_list::materialize(std::span<const size_t> indices) const
+{
+    // 按选中题目的文本总量确定内存区的块大小
+    size_t bytes = 0;
+    for(size_t i : indices)
+    {
+        bytes += views_[i].content.size() + views_[i].correct_answer.size();
+        for(const auto & opt : views_[i].options) bytes += opt.text.size() + 1 + sizeof(uint32_t);
+    }
+
+    question_bank bank;
+    bank.files() = files_;
+    std::pmr::memory_resource * arena = bank.new_arena(bytes);
+    bank.questions().reserve(indices.size());
+    for(size_t i : indices)
+    {
+        bank.questions().push_back(views_[i].materialize(arena));
+    }
+    return bank;
+}
@@ -0,0 +1,70 @@
+﻿#pragma once
+
+#include "question.h"
+#include "question_bank.h"
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// 题目的只读视图: 字符串直接指向源文本 (内存映射的文件)，不做任何拷贝
+// 只有需要改写的少量文本 (屏蔽了内联答案的题干、规范化后的答案) 另存在 question_view_list 的内存区中
+// 字段与 question 一一对应，区别只在于 \r 尚未去除、选项数组不是扁平存放的
+struct question_view
+{
+    question_type type = question_type::unknown;
+    uint32_t file_id = 0;        // 来源文件在 question_view_list 文件表中的下标
+    uint64_t block_offset = 0;
+    std::string_view content;
+    std::span<const option_view> options;
+    std::string_view correct_answer;
+    uint32_t answer_mask = 0;
+
+    size_t id = 0;   // 与 materialize() 得到的 question::get_id() 相同
+
+    size_t get_id() const
+    {
+        return id;
+    }
+
+    // 按 question::update_id() 的规则计算 ID (跳过 \r，等价于对去掉 \r 后的文本计算)
+    void update_id();
+
+    // 生成拥有字符串的题目 (只在开始答题时调用)
+    question materialize(const question::allocator_type & alloc = {}) const;
+};
+
+// 一组题目视图及其引用的全部数据
+// 持有源数据 (映射的文件、转码后的文本) 的所有权，视图在列表销毁前一直有效
+class question_view_list
+{
+public:
+    std::vector<question_view> & views() { return views_; }
+    const std::vector<question_view> & views() const { return views_; }
+
+    size_t size() const { return views_.size(); }
+    bool empty() const { return views_.empty(); }
+
+    // 新建一个内存区，存放改写后的文本和选项数组 (只能在一个线程中使用)
+    std::pmr::memory_resource * new_arena();
+
+    // 来源文件表: question_view::file_id 是表中的下标
+    const std::vector<source_file> & files() const { return files_; }
+    uint32_t add_file(source_file file);
+
+    // 保存源数据的所有者，使视图指向的内存保持有效
+    void keep_alive(std::shared_ptr<const void> owner);
+
+    // 把另一个列表的视图追加到末尾，并接管它持有的数据 (文件表随之合并，file_id 重新编号)
+    void append(question_view_list && other);
+
+    // 把选中的题目 (按 indices 的顺序) 生成到一个新题库中，文件表原样复制
+    question_bank materialize(std::span<const size_t> indices) const;
+
+private:
+    std::vector<std::shared_ptr<const void>> owners_;
+    std::vector<std::unique_ptr<std::pmr::monotonic_buffer_resource>> arenas_;
+    std::vector<source_file> files_;
+    std::vector<question_view> views_;   // 最后声明: 先于它引用的数据销毁
+};
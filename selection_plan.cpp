@@ -0,0 +1,114 @@
+﻿#include "selection_plan.h"
+
+#include <algorithm>
+#include <bit>
+#include <unordered_set>
+
+selection_plan::selection_plan(const selection_filters & filters)
+{
+    for(size_t i = 0; i < filters.types.size(); ++i) type_allowed_[i] = filters.types[i];
+
+    mistake_op_ = filters.mistake_op;
+    mistake_count_ = filters.mistake_count;
+    dedup_ = filters.strategy.exclude_duplicates;
+    exclude_multi_all_ = filters.strategy.exclude_multi_all;
+
+    const auto single = static_cast<size_t>(question_type::single);
+    const auto judge = static_cast<size_t>(question_type::judge);
+    for(size_t i = 0; i < filters.strategy.skip_single_options.size(); ++i)
+    {
+        if(filters.strategy.skip_single_options[i]) skip_options_[single] |= 1u << i;
+    }
+    for(size_t i = 0; i < filters.strategy.skip_judge_options.size(); ++i)
+    {
+        if(filters.strategy.skip_judge_options[i]) skip_options_[judge] |= 1u << i;
+    }
+    if(filters.strategy.skip_single_most_common) most_common_[single] = filters.most_common_single;
+    if(filters.strategy.skip_judge_most_common) most_common_[judge] = filters.most_common_judge;
+
+    has_answer_rules_ = exclude_multi_all_ || skip_options_[single] || skip_options_[judge] || most_common_[single] || most_common_[judge];
+}
+
+template<typename Pred>
+void selection_plan::and_with(bitset & bits, size_t rows, Pred pred)
+{
+    for(size_t w = 0; w < bits.size(); ++w)
+    {
+        if(bits[w] == 0) continue;
+
+        size_t first = w * 64;
+        size_t last = std::min(first + 64, rows);
+        uint64_t word = 0;
+        for(size_t row = first; row < last; ++row)
+        {
+            word |= static_cast<uint64_t>(pred(row)) << (row - first);
+        }
+        bits[w] &= word;
+    }
+}
+
+bool selection_plan::skips_answer(uint8_t type, uint32_t mask, uint16_t option_count) const
+{
+    // 多选全选题: 答案的选项个数等于选项数量
+    if(type == static_cast<uint8_t>(question_type::multi))
+    {
+        return exclude_multi_all_ && option_count > 0 && std::popcount(mask) >= option_count;
+    }
+
+    // 没有可识别答案的题目不跳过
+    if(mask == 0) return false;
+
+    // 最常见答案 (可能有多个，如 AB): 答案的字母都属于最常见答案
+    if(uint32_t common = most_common_[type]; common != 0 && (mask & ~common) == 0) return true;
+
+    // 单独选项跳过: 只针对单个字母的答案
+    return std::has_single_bit(mask) && (mask & skip_options_[type]) != 0;
+}
+
+std::vector<size_t> selection_plan::select(const bank_index & index) const
+{
+    const size_t rows = index.size();
+    const auto types = index.types();
+    const auto masks = index.answer_masks();
+    const auto option_counts = index.option_counts();
+    const auto ids = index.ids();
+    const auto mistakes = index.mistake_counts();
+
+    // 初始全选 (最后一个字的多余位清零)
+    bitset bits((rows + 63) / 64, ~uint64_t{ 0 });
+    if(rows % 64 != 0) bits.back() = (uint64_t{ 1 } << (rows % 64)) - 1;
+
+    and_with(bits, rows, [&](size_t row) { return type_allowed_[types[row]]; });
+
+    if(mistake_op_ == 1) and_with(bits, rows, [&](size_t row) { return mistakes[row] >= mistake_count_; });
+    if(mistake_op_ == 2) and_with(bits, rows, [&](size_t row) { return mistakes[row] == mistake_count_; });
+
+    if(has_answer_rules_)
+    {
+        and_with(bits, rows, [&](size_t row) { return !skips_answer(types[row], masks[row], option_counts[row]); });
+    }
+
+    // 去重: 只保留每个 ID 第一次出现的行 (与其他条件无关，必须扫描全部行)
+    if(dedup_)
+    {
+        bitset first_seen((rows + 63) / 64, 0);
+        std::unordered_set<size_t> seen_ids;
+        seen_ids.reserve(rows);
+        for(size_t row = 0; row < rows; ++row)
+        {
+            if(seen_ids.insert(ids[row]).second) first_seen[row / 64] |= uint64_t{ 1 } << (row % 64);
+        }
+        for(size_t w = 0; w < bits.size(); ++w) bits[w] &= first_seen[w];
+    }
+
+    // 取出置位的行号
+    std::vector<size_t> selected;
+    for(size_t w = 0; w < bits.size(); ++w)
+    {
+        for(uint64_t word = bits[w]; word != 0; word &= word - 1)
+        {
+            selected.push_back(w * 64 + static_cast<size_t>(std::countr_zero(word)));
+        }
+    }
+    return selected;
+}
@@ -0,0 +1,47 @@
+﻿#pragma once
+
+#include "question.h"
+#include "bank_index.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// 练习筛选条件: 首页的题型和错题设置 + 题库的刷题策略 (与界面无关)
+struct selection_filters
+{
+    std::array<bool, 4> types = { true, true, true, true }; // 单选/多选/判断/填空，顺序同 question_type
+    int mistake_op = 0;                 // 0 不限，1 错误次数 >= mistake_count，2 错误次数 == mistake_count
+    uint32_t mistake_count = 0;
+    practice_strategy strategy;
+    uint32_t most_common_single = 0;    // 统计得到的最常见单选答案 (位掩码)，strategy 开启跳过时使用
+    uint32_t most_common_judge = 0;
+};
+
+// 题目筛选引擎: 构造时把筛选条件编译成按题型查表的规则，select() 在列式索引上
+// 每个条件生成一个位图 (每行一位)，按 64 位字做 AND，最后取出置位的行号
+class selection_plan
+{
+public:
+    explicit selection_plan(const selection_filters & filters);
+
+    // 返回选中的行号 (升序，即题目的原顺序)
+    std::vector<size_t> select(const bank_index & index) const;
+
+private:
+    using bitset = std::vector<uint64_t>;
+
+    // 对每行求 pred(row)，结果与 bits 按字 AND；已全为 0 的字跳过
+    template<typename Pred>
+    static void and_with(bitset & bits, size_t rows, Pred pred);
+
+    bool skips_answer(uint8_t type, uint32_t mask, uint16_t option_count) const;
+
+    std::array<bool, 256> type_allowed_{};      // 下标为 question_type
+    int mistake_op_ = 0;
+    uint32_t mistake_count_ = 0;
+    bool dedup_ = false;
+    bool exclude_multi_all_ = false;
+    bool has_answer_rules_ = false;             // 是否有任何跳过规则 (没有时省掉这一遍)
+    std::array<uint32_t, 256> skip_options_{};  // 按题型: 需要跳过的单个字母答案
+    std::array<uint32_t, 256> most_common_{};   // 按题型: 最常见答案，0 表示不按最常见答案跳过
+};
@@ -1,10 +1,121 @@
 ﻿#include "storage_manager.h"
 
-
+#include <algorithm>
 
 #include <QJsonArray>
+#include <QSaveFile>
 #include <QDebug>
 
+// 各 JSON 文件中单个条目与类型之间的转换 (供 storage_manager 的类型化缓存使用)
+namespace
+{
+    exam_config exam_config_from_json(const std::string &, const QJsonObject & ex)
+    {
+        return
+        {
+            (size_t)ex.value("cnt_single").toInt(10),
+            (size_t)ex.value("cnt_multi").toInt(5),
+            (size_t)ex.value("cnt_judge").toInt(5),
+            (size_t)ex.value("cnt_fill").toInt(5),
+            ex.value("sc_single").toDouble(2.0),
+            ex.value("sc_multi").toDouble(4.0),
+            ex.value("sc_judge").toDouble(2.0),
+            ex.value("sc_fill").toDouble(2.0),
+            (size_t)ex.value("duration").toInt(45)
+        };
+    }
+
+    QJsonObject exam_config_to_json(const exam_config & cfg)
+    {
+        QJsonObject ex;
+        ex["cnt_single"] = (qint64)cfg.single_count;
+        ex["cnt_multi"] = (qint64)cfg.multi_count;
+        ex["cnt_judge"] = (qint64)cfg.judge_count;
+        ex["cnt_fill"] = (qint64)cfg.fill_count;
+        ex["sc_single"] = cfg.single_score;
+        ex["sc_multi"] = cfg.multi_score;
+        ex["sc_judge"] = cfg.judge_score;
+        ex["sc_fill"] = cfg.fill_score;
+        ex["duration"] = (qint64)cfg.exam_duration;
+        return ex;
+    }
+
+    parser_strategy parser_strategy_from_json(const std::string & name, const QJsonObject & s)
+    {
+        parser_strategy strategy;
+        strategy.name = name;
+        strategy.single_keywords = s.value("single_keywords").toString().toStdString();
+        strategy.multi_keywords = s.value("multi_keywords").toString().toStdString();
+        strategy.judge_keywords = s.value("judge_keywords").toString().toStdString();
+        strategy.fill_keywords = s.value("fill_keywords").toString().toStdString();
+        strategy.answer_keywords = s.value("answer_keywords").toString().toStdString();
+        strategy.garbage_patterns = s.value("garbage_patterns").toString().toStdString();
+        strategy.judge_true_values = s.value("judge_true_values").toString().toStdString();
+        strategy.judge_false_values = s.value("judge_false_values").toString().toStdString();
+        return strategy;
+    }
+
+    QJsonObject parser_strategy_to_json(const parser_strategy & strategy)
+    {
+        QJsonObject s;
+        s["single_keywords"] = QString::fromStdString(strategy.single_keywords);
+        s["multi_keywords"] = QString::fromStdString(strategy.multi_keywords);
+        s["judge_keywords"] = QString::fromStdString(strategy.judge_keywords);
+        s["fill_keywords"] = QString::fromStdString(strategy.fill_keywords);
+        s["answer_keywords"] = QString::fromStdString(strategy.answer_keywords);
+        s["garbage_patterns"] = QString::fromStdString(strategy.garbage_patterns);
+        s["judge_true_values"] = QString::fromStdString(strategy.judge_true_values);
+        s["judge_false_values"] = QString::fromStdString(strategy.judge_false_values);
+        return s;
+    }
+
+    practice_strategy practice_strategy_from_json(const std::string &, const QJsonObject & s)
+    {
+        practice_strategy result;
+        result.skip_single_most_common = s.value("skip_single_most_common").toBool(false);
+        result.skip_judge_most_common = s.value("skip_judge_most_common").toBool(false);
+        result.exclude_duplicates = s.value("exclude_duplicates").toBool(false);
+        result.exclude_multi_all = s.value("exclude_multi_all").toBool(false);
+
+        // 单选选项跳过
+        QJsonArray singleOpts = s.value("skip_single_options").toArray();
+        for(int i = 0; i < std::min((int)singleOpts.size(), 4); ++i) {
+            result.skip_single_options[i] = singleOpts[i].toBool(false);
+        }
+
+        // 判断选项跳过
+        QJsonArray judgeOpts = s.value("skip_judge_options").toArray();
+        for(int i = 0; i < std::min((int)judgeOpts.size(), 2); ++i) {
+            result.skip_judge_options[i] = judgeOpts[i].toBool(false);
+        }
+        return result;
+    }
+
+    QJsonObject practice_strategy_to_json(const practice_strategy & strategy)
+    {
+        QJsonObject s;
+        s["skip_single_most_common"] = strategy.skip_single_most_common;
+        s["skip_judge_most_common"] = strategy.skip_judge_most_common;
+        s["exclude_duplicates"] = strategy.exclude_duplicates;
+        s["exclude_multi_all"] = strategy.exclude_multi_all;
+
+        // 单选选项跳过
+        QJsonArray singleOpts;
+        for(int i = 0; i < 4; ++i) {
+            singleOpts.append(strategy.skip_single_options[i]);
+        }
+        s["skip_single_options"] = singleOpts;
+
+        // 判断选项跳过
+        QJsonArray judgeOpts;
+        for(int i = 0; i < 2; ++i) {
+            judgeOpts.append(strategy.skip_judge_options[i]);
+        }
+        s["skip_judge_options"] = judgeOpts;
+        return s;
+    }
+}
+
 
 // config.json
 void storage_manager::load_config()
@@ -73,130 +184,102 @@ void storage_manager::update_config(const app_config & new_config)
 std::vector<std::string> storage_manager::get_exam_config_names() const
 {
     std::vector<std::string> names;
-    
-    if(auto obj_opt = get_json_object(exam_configs_file_))
+    for(const auto & [name, cfg] : cached(exam_configs_, exam_configs_file_, exam_config_from_json))
     {
-        const auto & obj = *obj_opt;
-        for(auto it = obj.begin(); it != obj.end(); ++it)
-        {
-            names.push_back(it.key().toStdString());
-        }
+        names.push_back(name);
     }
-    
     return names;
 }
 
 bool storage_manager::load_exam_config_by_name(const std::string & name)
 {
-    if(auto obj_opt = get_json_object(exam_configs_file_))
+    const auto & configs = cached(exam_configs_, exam_configs_file_, exam_config_from_json);
+    if(auto it = configs.find(name); it != configs.end())
     {
-        const auto & obj = *obj_opt;
-        QString qname = QString::fromStdString(name);
-        
-        if(obj.contains(qname))
-        {
-            QJsonObject ex = obj[qname].toObject();
-            exam_config_ = 
-            {
-                (size_t)ex.value("cnt_single").toInt(10),
-                (size_t)ex.value("cnt_multi").toInt(5),
-                (size_t)ex.value("cnt_judge").toInt(5),
-                (size_t)ex.value("cnt_fill").toInt(5),
-                ex.value("sc_single").toDouble(2.0),
-                ex.value("sc_multi").toDouble(4.0),
-                ex.value("sc_judge").toDouble(2.0),
-                ex.value("sc_fill").toDouble(2.0),
-                (size_t)ex.value("duration").toInt(45)
-            };
-            return true;
-        }
+        exam_config_ = it->second;
+        return true;
     }
     return false;
 }
 
 void storage_manager::save_exam_config_as(const std::string & name, const exam_config & cfg)
 {
-    modify_json(exam_configs_file_, QJsonDocument::Indented, [&](QJsonObject & obj)
-    {
-        // 先读取现有配置
-        obj = get_json_object(exam_configs_file_).value_or(QJsonObject{});
-        
-        QJsonObject ex;
-        ex["cnt_single"] = (qint64)cfg.single_count;
-        ex["cnt_multi"] = (qint64)cfg.multi_count;
-        ex["cnt_judge"] = (qint64)cfg.judge_count;
-        ex["cnt_fill"] = (qint64)cfg.fill_count;
-        ex["sc_single"] = cfg.single_score;
-        ex["sc_multi"] = cfg.multi_score;
-        ex["sc_judge"] = cfg.judge_score;
-        ex["sc_fill"] = cfg.fill_score;
-        ex["duration"] = (qint64)cfg.exam_duration;
+    cached(exam_configs_, exam_configs_file_, exam_config_from_json);
+    exam_configs_.entries[name] = cfg;
+    write_through(exam_configs_, exam_configs_file_, exam_config_to_json);
 
-        obj[QString::fromStdString(name)] = ex;
-    });
-    
     exam_config_ = cfg;
 }
 
 void storage_manager::delete_exam_config(const std::string & name)
 {
-    modify_json(exam_configs_file_, QJsonDocument::Indented, [&](QJsonObject & obj)
-    {
-        obj = get_json_object(exam_configs_file_).value_or(QJsonObject{});
-        obj.remove(QString::fromStdString(name));
-    });
+    cached(exam_configs_, exam_configs_file_, exam_config_from_json);
+    exam_configs_.entries.erase(name);
+    write_through(exam_configs_, exam_configs_file_, exam_config_to_json);
 }
 
-// mistakes.json
+// 错题: 二进制索引 (只读映射) + 追加日志
 
 void storage_manager::load_mistakes()
 {
-    mistakes_.clear();
+    // 映射索引 + 日志重放；数据目录可能被 load_config 改过，这里按当前路径重新打开
+    mistake_journal_ = std::make_unique<mistake_journal>(get_json_path(mistake_file_), *writer_);
+    mistake_delta_ = mistake_journal_->load();
 
-    max_mistake_ = 0;
-
-    if(auto obj_opt = get_json_object(mistake_file_))
+    max_mistake_ = mistake_journal_->index().max_count();
+    for(const auto & [id, count] : mistake_delta_)
     {
-        const QJsonObject & obj = *obj_opt;
-
-        for(auto it = obj.begin(); it != obj.end(); ++it)
-        {
-            size_t id = it.key().toULongLong();
-            int count = it.value().toInt();
-            mistakes_[id] = count;
-
-            if(static_cast<size_t>(count) > max_mistake_) max_mistake_ = static_cast<size_t>(count);
-        }
+        if(count > max_mistake_) max_mistake_ = count;
     }
 }
 
-void storage_manager::save_mistakes()
-{
-    modify_json(mistake_file_, QJsonDocument::Compact, [this](QJsonObject & obj)
-        {
-            for(const auto & [id, count] : mistakes_)
-            {
-                obj[QString::number(id)] = static_cast<qint64>(count);
-            }
-        });
-}
-
 void storage_manager::add_mistake(const question & q)
 {
-    if(auto current_count = ++mistakes_[q.get_id()]; current_count > max_mistake_)
+    // 第一次变化时以索引中的次数为起点
+    const size_t id = q.get_id();
+    auto [it, inserted] = mistake_delta_.try_emplace(id, 0);
+    if(inserted) it->second = mistake_journal_->index().find(id);
+
+    if(auto current_count = ++it->second; current_count > max_mistake_)
     {
         max_mistake_ = current_count;
     }
 
-    save_mistakes();
+    // 只追加一条记录，索引由日志在后台压缩时重建
+    mistake_journal_->append(id, 1);
 }
 
 int storage_manager::get_mistake_count(const question & q) const
 {
-    size_t id = q.get_id();
-    if(mistakes_.contains(id))
-        return static_cast<int>(mistakes_.at(id));
-    return 0;
+    return get_mistake_count(q.get_id());
+}
+
+int storage_manager::get_mistake_count(size_t id) const
+{
+    if(auto it = mistake_delta_.find(id); it != mistake_delta_.end())
+        return static_cast<int>(it->second);
+    return static_cast<int>(mistake_journal_->index().find(id));
+}
+
+bool storage_manager::export_mistakes(const std::filesystem::path & path) const
+{
+    // 导出为旧版 mistakes.json 的格式: { "题目 ID": 错误次数 }
+    QJsonObject obj;
+    mistake_journal_->index().for_each([&](size_t id, uint32_t count)
+        {
+            if(!mistake_delta_.contains(id)) obj[QString::number(id)] = static_cast<qint64>(count);
+        });
+    for(const auto & [id, count] : mistake_delta_)
+    {
+        if(count > 0) obj[QString::number(id)] = static_cast<qint64>(count);
+    }
+
+    // QSaveFile 写完整才替换目标文件，磁盘写满等中途失败不会留下半截的导出文件
+    QSaveFile file(platform_utils::to_q_path(path));
+    if(!file.open(QIODevice::WriteOnly)) return false;
+    const QByteArray data = QJsonDocument(obj).toJson(QJsonDocument::Compact);
+    if(file.write(data) != data.size()) return false;
+    return file.commit();
 }
 
 
@@ -205,13 +288,10 @@ std::vector<std::pair<question, int>> storage_manager::filter_mistakes(const std
 {
     std::vector<std::pair<question, int>> result;
 
-    result.reserve(mistakes_.size());
-
     for(const auto & q : all_questions)
     {
-        if(size_t id = q.get_id(); mistakes_.contains(id))
+        if(int count = get_mistake_count(q.get_id()); count > 0)
         {
-            int count = static_cast<int>(mistakes_.at(id));
             result.push_back({ q, count });
         }
     }
@@ -220,61 +300,181 @@ std::vector<std::pair<question, int>> storage_manager::filter_mistakes(const std
 }
 
 
-// history.json
+// 历史: history/<题库名哈希>.log
 
 void storage_manager::add_exam_record(const exam_record & record)
 {
-    modify_json(history_file_, QJsonDocument::Indented, [&](QJsonObject & obj)
+    {
+        std::lock_guard lock(pending_history_->mutex);
+        pending_history_->records.push_back(record);
+    }
+
+    // 只在该题库的日志末尾追加一条定长记录 (写盘线程中执行，不持锁)，写完后从待写列表移出
+    writer_->post([log = history_, pending = pending_history_]()
         {
-            obj = get_json_object(history_file_).value_or(QJsonObject{});
-
-            QJsonObject new_rec;
-            new_rec["date"] = QString::fromStdString(record.date);
-            new_rec["score"] = record.score;
-            new_rec["total_score"] = record.total_score;
-            new_rec["duration"] = record.duration_sec;
-            new_rec["correct"] = record.correct_count;
-            new_rec["total"] = record.total_count;
-
-            QString q_repo_name = QString::fromStdString(record.repo_name);
-            QJsonArray arr = obj.value(q_repo_name).toArray(); // 根据题库名查找对应的数组
-            arr.prepend(new_rec);                              // 新记录放在最前
-            obj[q_repo_name] = arr;                            // 更新后的数组放回对象
+            exam_record record;
+            bool counted = false;
+            {
+                std::lock_guard lock(pending->mutex);
+                record = pending->records.front();
+                counted = pending->disk_counts.contains(record.repo_name);
+            }
+
+            // 追加前先登记磁盘记录数，读取方据此判断快照中哪些记录已在磁盘上
+            if(!counted)
+            {
+                const size_t count = log.count(record.repo_name);
+                std::lock_guard lock(pending->mutex);
+                pending->disk_counts.try_emplace(record.repo_name, count);
+            }
+
+            const bool written = log.append(record);
+            if(!written)
+            {
+                qWarning() << "Failed to append exam record for" << QString::fromStdString(record.repo_name);
+            }
+
+            std::lock_guard lock(pending->mutex);
+            pending->records.erase(pending->records.begin());
+            if(written) ++pending->disk_counts[record.repo_name];
         });
+}
+
+size_t storage_manager::snapshot_history(const std::string & repo_name, std::vector<exam_record> & pending) const
+{
+    std::unique_lock lock(pending_history_->mutex);
 
+    auto known = pending_history_->disk_counts.find(repo_name);
+    if(known == pending_history_->disk_counts.end())
+    {
+        // 第一次读取该题库: 在锁外读出记录数。写盘线程追加前会先登记，重新加锁后仍未登记说明期间没有追加
+        lock.unlock();
+        const size_t count = history_.count(repo_name);
+        lock.lock();
+        known = pending_history_->disk_counts.try_emplace(repo_name, count).first;
+    }
+
+    for(const auto & record : pending_history_->records)
+    {
+        if(record.repo_name == repo_name) pending.push_back(record);
+    }
+    return known->second;
 }
 
-std::vector<exam_record> storage_manager::get_history(const std::string & repo_name) const
+std::vector<exam_record> storage_manager::get_history(const std::string & repo_name, size_t offset, size_t limit) const
 {
+    std::vector<exam_record> pending;
+    const size_t disk_count = snapshot_history(repo_name, pending);
+
+    // 还没写入的记录比磁盘上的都新: 先按最新在前取这部分，不够再从磁盘读 (快照之后追加的不算)
     std::vector<exam_record> list;
+    for(size_t i = offset; i < pending.size() && list.size() < limit; ++i)
+    {
+        list.push_back(std::move(pending[pending.size() - 1 - i]));
+    }
 
-    if(auto obj_opt = get_json_object(history_file_))
+    if(list.size() == limit) return list;
+    const size_t disk_offset = offset > pending.size() ? offset - pending.size() : 0;
+    for(auto & record : history_.read(repo_name, disk_offset, limit - list.size(), disk_count))
     {
-        const auto & obj = obj_opt.value();
+        list.push_back(std::move(record));
+    }
+    return list;
+}
 
-        QString q_repo_name = QString::fromStdString(repo_name);
+size_t storage_manager::get_history_count(const std::string & repo_name) const
+{
+    std::vector<exam_record> pending;
+    const size_t disk_count = snapshot_history(repo_name, pending);
+    return disk_count + pending.size();
+}
 
-        if(obj.contains(q_repo_name))
+void storage_manager::migrate_history()
+{
+    auto obj_opt = get_json_object(history_file_);
+    if(!obj_opt) return;
+
+    auto same_record = [](const exam_record & a, const exam_record & b)
+        {
+            return a.date == b.date && a.score == b.score && a.total_score == b.total_score && a.duration_sec == b.duration_sec
+                && a.correct_count == b.correct_count && a.total_count == b.total_count;
+        };
+
+    // 旧文件中每个题库的数组最新在前，按时间顺序 (倒序) 写入
+    bool migrated = true;
+    const auto & obj = *obj_opt;
+    for(auto it = obj.begin(); it != obj.end(); ++it)
+    {
+        const std::string repo_name = it.key().toStdString();
+        const QJsonArray arr = it.value().toArray();
+        std::vector<exam_record> records;
+        records.reserve(static_cast<size_t>(arr.size()));
+        for(qsizetype i = arr.size(); i-- > 0;)
         {
-            QJsonArray arr = obj.value(q_repo_name).toArray();
-            list.reserve(arr.size());
+            QJsonObject o = arr.at(i).toObject();
+            exam_record r;
+            r.repo_name = repo_name;
+            r.date = o["date"].toString().toStdString();
+            r.score = o["score"].toDouble();
+            r.total_score = o["total_score"].toDouble();
+            r.duration_sec = o["duration"].toInt();
+            r.correct_count = o["correct"].toInt();
+            r.total_count = o["total"].toInt();
+            records.push_back(std::move(r));
+        }
 
-            for(const auto & val : arr)
-            {
-                QJsonObject o = val.toObject();
-                exam_record r;
-                r.repo_name = repo_name;
-                r.date = o["date"].toString().toStdString();
-                r.score = o["score"].toDouble();
-                r.total_score = o["total_score"].toDouble();
-                r.duration_sec = o["duration"].toInt();
-                r.correct_count = o["correct"].toInt();
-                r.total_count = o["total"].toInt();
-                list.push_back(std::move(r));
-            }
+        // 上次迁移在改名前中断时，日志开头已有 (部分) 迁移的记录，之后可能还有新考试的记录:
+        // 已完整迁移的题库跳过；否则按旧记录 + 日志中不属于迁移的记录整体重写，不重复也不丢
+        std::vector<exam_record> logged = history_.read(repo_name);
+        std::ranges::reverse(logged);
+        size_t done = 0;
+        while(done < logged.size() && done < records.size() && same_record(logged[done], records[done])) ++done;
+        if(done == records.size()) continue;
+
+        records.insert(records.end(), std::make_move_iterator(logged.begin() + done), std::make_move_iterator(logged.end()));
+        if(!history_.replace(repo_name, records))
+        {
+            qWarning() << "Failed to migrate exam history for" << QString::fromStdString(repo_name);
+            migrated = false;
         }
     }
-    return list;
+
+    // 有题库没写成功时保留旧文件，下次启动重试
+    if(!migrated) return;
+
+    // 迁移只做一次: 旧文件改名保留
+    QString path = platform_utils::to_q_path(get_json_path(history_file_));
+    QFile::remove(path + ".bak");
+    QFile::rename(path, path + ".bak");
+}
+
+bool storage_manager::export_history(const std::filesystem::path & path) const
+{
+    writer_->flush();
+
+    QJsonObject obj;
+    for(const auto & repo_name : history_.repo_names())
+    {
+        QJsonArray arr;
+        for(const auto & record : history_.read(repo_name))
+        {
+            QJsonObject rec;
+            rec["date"] = QString::fromStdString(record.date);
+            rec["score"] = record.score;
+            rec["total_score"] = record.total_score;
+            rec["duration"] = record.duration_sec;
+            rec["correct"] = record.correct_count;
+            rec["total"] = record.total_count;
+            arr.append(rec);
+        }
+        obj[QString::fromStdString(repo_name)] = arr;
+    }
+
+    QSaveFile file(platform_utils::to_q_path(path));
+    if(!file.open(QIODevice::WriteOnly)) return false;
+    const QByteArray data = QJsonDocument(obj).toJson(QJsonDocument::Indented);
+    if(file.write(data) != data.size()) return false;
+    return file.commit();
 }
 
 // parser_strategies.json - 解析策略管理
@@ -282,136 +482,52 @@ std::vector<exam_record> storage_manager::get_history(const std::string & repo_n
 std::vector<std::string> storage_manager::get_parser_strategy_names() const
 {
     std::vector<std::string> names;
-    
-    if(auto obj_opt = get_json_object(parser_strategies_file_))
+    for(const auto & [name, strategy] : cached(parser_strategies_, parser_strategies_file_, parser_strategy_from_json))
     {
-        const auto& obj = *obj_opt;
-        for(auto it = obj.begin(); it != obj.end(); ++it)
-        {
-            names.push_back(it.key().toStdString());
-        }
+        names.push_back(name);
     }
-    
     return names;
 }
 
 std::optional<parser_strategy> storage_manager::get_parser_strategy(const std::string& name) const
 {
-    if(auto obj_opt = get_json_object(parser_strategies_file_))
+    const auto & strategies = cached(parser_strategies_, parser_strategies_file_, parser_strategy_from_json);
+    if(auto it = strategies.find(name); it != strategies.end())
     {
-        const auto& obj = *obj_opt;
-        QString qname = QString::fromStdString(name);
-        
-        if(obj.contains(qname))
-        {
-            QJsonObject s = obj[qname].toObject();
-            parser_strategy strategy;
-            strategy.name = name;
-            strategy.single_keywords = s.value("single_keywords").toString().toStdString();
-            strategy.multi_keywords = s.value("multi_keywords").toString().toStdString();
-            strategy.judge_keywords = s.value("judge_keywords").toString().toStdString();
-            strategy.fill_keywords = s.value("fill_keywords").toString().toStdString();
-            strategy.answer_keywords = s.value("answer_keywords").toString().toStdString();
-            strategy.garbage_patterns = s.value("garbage_patterns").toString().toStdString();
-            strategy.judge_true_values = s.value("judge_true_values").toString().toStdString();
-            strategy.judge_false_values = s.value("judge_false_values").toString().toStdString();
-            return strategy;
-        }
+        return it->second;
     }
     return std::nullopt;
 }
 
 void storage_manager::save_parser_strategy(const parser_strategy& strategy)
 {
-    modify_json(parser_strategies_file_, QJsonDocument::Indented, [&](QJsonObject& obj)
-    {
-        // 先读取现有配置
-        obj = get_json_object(parser_strategies_file_).value_or(QJsonObject{});
-        
-        QJsonObject s;
-        s["single_keywords"] = QString::fromStdString(strategy.single_keywords);
-        s["multi_keywords"] = QString::fromStdString(strategy.multi_keywords);
-        s["judge_keywords"] = QString::fromStdString(strategy.judge_keywords);
-        s["fill_keywords"] = QString::fromStdString(strategy.fill_keywords);
-        s["answer_keywords"] = QString::fromStdString(strategy.answer_keywords);
-        s["garbage_patterns"] = QString::fromStdString(strategy.garbage_patterns);
-        s["judge_true_values"] = QString::fromStdString(strategy.judge_true_values);
-        s["judge_false_values"] = QString::fromStdString(strategy.judge_false_values);
-
-        obj[QString::fromStdString(strategy.name)] = s;
-    });
+    cached(parser_strategies_, parser_strategies_file_, parser_strategy_from_json);
+    parser_strategies_.entries[strategy.name] = strategy;
+    write_through(parser_strategies_, parser_strategies_file_, parser_strategy_to_json);
 }
 
 void storage_manager::delete_parser_strategy(const std::string& name)
 {
-    modify_json(parser_strategies_file_, QJsonDocument::Indented, [&](QJsonObject& obj)
-    {
-        obj = get_json_object(parser_strategies_file_).value_or(QJsonObject{});
-        obj.remove(QString::fromStdString(name));
-    });
+    cached(parser_strategies_, parser_strategies_file_, parser_strategy_from_json);
+    parser_strategies_.entries.erase(name);
+    write_through(parser_strategies_, parser_strategies_file_, parser_strategy_to_json);
 }
 
 // practice_strategies.json - 刷题策略管理（按题库）
 
 practice_strategy storage_manager::get_practice_strategy(const std::string& repo_name) const
 {
-    practice_strategy result;
-    
-    if(auto obj_opt = get_json_object(practice_strategies_file_))
+    const auto & strategies = cached(practice_strategies_, practice_strategies_file_, practice_strategy_from_json);
+    if(auto it = strategies.find(repo_name); it != strategies.end())
     {
-        const auto& obj = *obj_opt;
-        QString qname = QString::fromStdString(repo_name);
-        
-        if(obj.contains(qname))
-        {
-            QJsonObject s = obj[qname].toObject();
-            result.skip_single_most_common = s.value("skip_single_most_common").toBool(false);
-            result.skip_judge_most_common = s.value("skip_judge_most_common").toBool(false);
-            result.exclude_duplicates = s.value("exclude_duplicates").toBool(false);
-            result.exclude_multi_all = s.value("exclude_multi_all").toBool(false);
-            
-            // 单选选项跳过
-            QJsonArray singleOpts = s.value("skip_single_options").toArray();
-            for(int i = 0; i < std::min((int)singleOpts.size(), 4); ++i) {
-                result.skip_single_options[i] = singleOpts[i].toBool(false);
-            }
-            
-            // 判断选项跳过
-            QJsonArray judgeOpts = s.value("skip_judge_options").toArray();
-            for(int i = 0; i < std::min((int)judgeOpts.size(), 2); ++i) {
-                result.skip_judge_options[i] = judgeOpts[i].toBool(false);
-            }
-        }
+        return it->second;
     }
-    return result;
+    return {};
 }
 
 void storage_manager::save_practice_strategy(const std::string& repo_name, const practice_strategy& strategy)
 {
-    modify_json(practice_strategies_file_, QJsonDocument::Indented, [&](QJsonObject& obj)
-    {
-        obj = get_json_object(practice_strategies_file_).value_or(QJsonObject{});
-        
-        QJsonObject s;
-        s["skip_single_most_common"] = strategy.skip_single_most_common;
-        s["skip_judge_most_common"] = strategy.skip_judge_most_common;
-        s["exclude_duplicates"] = strategy.exclude_duplicates;
-        s["exclude_multi_all"] = strategy.exclude_multi_all;
-        
-        // 单选选项跳过
-        QJsonArray singleOpts;
-        for(int i = 0; i < 4; ++i) {
-            singleOpts.append(strategy.skip_single_options[i]);
-        }
-        s["skip_single_options"] = singleOpts;
-        
-        // 判断选项跳过
-        QJsonArray judgeOpts;
-        for(int i = 0; i < 2; ++i) {
-            judgeOpts.append(strategy.skip_judge_options[i]);
-        }
-        s["skip_judge_options"] = judgeOpts;
-        
-        obj[QString::fromStdString(repo_name)] = s;
-    });
+    cached(practice_strategies_, practice_strategies_file_, practice_strategy_from_json);
+    practice_strategies_.entries[repo_name] = strategy;
+    write_through(practice_strategies_, practice_strategies_file_, practice_strategy_to_json);
 }
@@ -2,17 +2,25 @@
 
 #include "question.h" 
 #include "platform_utils.h"
+#include "mistake_journal.h"
+#include "history_log.h"
+#include "io_writer.h"
 #include "parser/parser_strategy.h"
 #include <string>
 #include <vector>
+#include <map>
 #include <unordered_map>
 #include <filesystem>
 #include <optional> 
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <string_view>
 
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
 #include <QJsonDocument>
 #include <QJsonObject>
 
@@ -35,7 +43,13 @@ public:
 
         load_all();
     }
-    ~storage_manager() = default;
+    ~storage_manager() = default; // 写盘线程析构时写完所有排队的任务
+
+    // 所有写入都在后台写盘线程中完成；阻塞直到此前提交的写入都已落盘 (退出、切到后台时调用)
+    void flush() { writer_->flush(); }
+
+    // 数据目录 (json 记录和缓存所在位置)
+    const std::filesystem::path & data_path() const { return root_path_; }
 
     storage_manager(const storage_manager &) = delete;
     storage_manager & operator=(const storage_manager &) = delete;
@@ -62,15 +76,20 @@ public:
     void delete_parser_strategy(const std::string& name);
     parser_strategy get_default_strategy() const { return parser_strategy::get_default(); }
 
-    // 错题 (Mistakes.json)
+    // 错题 (mistakes.<代号>.idx 二进制索引 + mistakes.<代号>.journal 追加日志，旧版 mistakes.json 首次启动时迁移)
     void add_mistake(const question &);
     int get_mistake_count(const question &) const;
+    int get_mistake_count(size_t question_id) const;
     size_t get_max_mistake()const { return max_mistake_; }
     std::vector<std::pair<question, int>> filter_mistakes(const std::vector<question> & all_questions) const;
+    bool export_mistakes(const std::filesystem::path & path) const; // 导出为 JSON
 
-    // 历史 (History.json)
+    // 历史 (history/ 下每个题库一个追加式日志，旧版 history.json 首次启动时迁移)
     void add_exam_record(const exam_record & record);
-    std::vector<exam_record> get_history(const std::string & repo_name) const;
+    // 最新在前；offset / limit 用于分页
+    std::vector<exam_record> get_history(const std::string & repo_name, size_t offset = 0, size_t limit = SIZE_MAX) const;
+    size_t get_history_count(const std::string & repo_name) const;
+    bool export_history(const std::filesystem::path & path) const;     // 导出为旧版 history.json 格式
 
     // 刷题策略 (practice_strategies.json) - 按题库保存
     practice_strategy get_practice_strategy(const std::string& repo_name) const;
@@ -112,17 +131,106 @@ private:
 
         modifier(root_obj);
 
-        // 写入
-        auto path = get_json_path(filename);
-        QFile file(platform_utils::to_q_path(path));
+        // 序列化后交给写盘线程整文件替换；同一文件连续多次保存只写最后一次
+        writer_->write_file(get_json_path(filename), QJsonDocument(root_obj).toJson(format));
+    }
+
+
+    // 按文件缓存的类型化数据 (解析策略、刷题策略、考试配置): 读取直接查内存，保存时写回文件
+    // 记录加载时文件的大小和修改时间，文件在磁盘上被改动后下次读取会自动重新加载
+    struct file_stamp
+    {
+        int64_t size = -1;
+        int64_t mtime = -1;
+
+        bool operator==(const file_stamp &) const = default;
+    };
 
-        // WriteOnly 会清空文件内容，准备重写
-        if(file.open(QIODevice::WriteOnly))
+    template<typename T>
+    struct json_cache
+    {
+        std::map<std::string, T> entries;
+        std::optional<file_stamp> stamp; // 空表示尚未加载
+        bool written = false;            // 保存后还没记下写入后的文件状态
+        uint64_t write_seq = 0;          // 最近一次保存的序号
+
+        // 写盘线程写完后在这里记下文件状态和对应的保存序号 (GUI 线程不等待写盘)
+        struct landed_stamp
         {
-            file.write(QJsonDocument(root_obj).toJson(format));
+            std::mutex mutex;
+            uint64_t seq = 0;
+            file_stamp stamp;
+        };
+        std::shared_ptr<landed_stamp> landed = std::make_shared<landed_stamp>();
+    };
+
+    static file_stamp stamp_of_path(const QString & path)
+    {
+        QFileInfo info(path);
+        if(!info.exists()) return {};
+        return { info.size(), info.lastModified().toMSecsSinceEpoch() };
+    }
+
+    file_stamp stamp_of(std::string_view filename) const
+    {
+        return stamp_of_path(platform_utils::to_q_path(get_json_path(filename)));
+    }
+
+    // from_json(名称, 条目对象) -> T
+    template<typename T, typename FromJson>
+    const std::map<std::string, T> & cached(json_cache<T> & cache, std::string_view filename, FromJson from_json) const
+    {
+        // 自己的保存: 内存中的内容就是 (即将) 写入的文件内容，不必重新解析
+        // 最近一次保存落盘后改用写盘线程记下的文件状态，之后磁盘上的改动照常触发重新加载
+        if(cache.written)
+        {
+            std::lock_guard lock(cache.landed->mutex);
+            if(cache.landed->seq != cache.write_seq) return cache.entries; // 还在写盘队列中
+            cache.stamp = cache.landed->stamp;
+            cache.written = false;
+            return cache.entries;
+        }
+
+        file_stamp stamp = stamp_of(filename);
+        if(cache.stamp == stamp) return cache.entries;
+
+        cache.entries.clear();
+        if(auto obj_opt = get_json_object(filename))
+        {
+            const auto & obj = *obj_opt;
+            for(auto it = obj.begin(); it != obj.end(); ++it)
+            {
+                std::string name = it.key().toStdString();
+                T value = from_json(name, it.value().toObject());
+                cache.entries.emplace(std::move(name), std::move(value));
+            }
         }
+        cache.stamp = stamp;
+        return cache.entries;
     }
 
+    // 把缓存整体写回文件 (后台写入)；写盘线程写完后记下文件状态，自己的写入不会触发重新加载
+    template<typename T, typename ToJson>
+    void write_through(json_cache<T> & cache, std::string_view filename, ToJson to_json)
+    {
+        modify_json(filename, QJsonDocument::Indented, [&](QJsonObject & obj)
+            {
+                for(const auto & [name, value] : cache.entries)
+                {
+                    obj[QString::fromStdString(name)] = to_json(value);
+                }
+            });
+        cache.written = true;
+
+        // 排在整文件写入之后执行 (task 不与前面的写入合并)
+        writer_->post([landed = cache.landed, path = platform_utils::to_q_path(get_json_path(filename)), seq = ++cache.write_seq]()
+            {
+                file_stamp stamp = stamp_of_path(path);
+                std::lock_guard lock(landed->mutex);
+                landed->seq = seq;
+                landed->stamp = stamp;
+            });
+    }
 
     void load_all()
     {
@@ -137,28 +245,53 @@ private:
         // exam_config 使用默认值，用户可从 UI 加载已保存配置
         exam_config_ = { 10, 5, 5, 5, 2.0, 4.0, 2.0, 2.0, 45 };
         load_mistakes();
+
+        history_ = history_log(root_path_ / history_dir_);
+        migrate_history();
     }
 
     void load_config();
     void save_config();
 
     void load_mistakes();
-    void save_mistakes();
+    void migrate_history();
+
+    // 取某个题库的历史快照: 返回磁盘上的记录数，pending 追加该题库还没写入的记录 (按提交顺序)
+    size_t snapshot_history(const std::string & repo_name, std::vector<exam_record> & pending) const;
 
 
     
 
+    std::unique_ptr<io_writer> writer_ = std::make_unique<io_writer>(); // 最先声明: 最后析构，其他成员提交的写入都能写完
     std::filesystem::path root_path_;
     std::filesystem::path config_root_path_; // 配置文件固定路径
     app_config config_;
     exam_config exam_config_;
-    std::unordered_map<size_t, size_t> mistakes_;
+    std::unique_ptr<mistake_journal> mistake_journal_; // 错题持久化: 映射的索引 + 追加日志
+    std::unordered_map<size_t, size_t> mistake_delta_; // 索引映射之后变化过的题目 (完整次数)，其余题目直接查索引
     size_t max_mistake_{};
+    history_log history_;
+
+    // 已提交、写盘线程还没写入的考试记录 (按提交顺序)，以及各题库已写入磁盘的记录数
+    // 写盘线程在锁外追加到文件，之后在锁内移出记录并把记录数加一，两者总是一致；
+    // 读取时在锁内取快照 (记录数 + 待写记录)，锁外只读磁盘上快照记录数以内的部分，不必等写盘队列
+    struct pending_history
+    {
+        std::mutex mutex;
+        std::vector<exam_record> records;
+        std::unordered_map<std::string, size_t> disk_counts; // 第一次用到某个题库时登记
+    };
+    std::shared_ptr<pending_history> pending_history_ = std::make_shared<pending_history>();
+
+    mutable json_cache<exam_config> exam_configs_;
+    mutable json_cache<parser_strategy> parser_strategies_;
+    mutable json_cache<practice_strategy> practice_strategies_;
 
     static constexpr std::string_view config_file_ = "config.json";
     static constexpr std::string_view exam_configs_file_ = "exam_configs.json";
     static constexpr std::string_view mistake_file_ = "mistakes.json";
-    static constexpr std::string_view history_file_ = "history.json";
+    static constexpr std::string_view history_file_ = "history.json";   // 旧版，只用于迁移
+    static constexpr std::string_view history_dir_ = "history";
     static constexpr std::string_view parser_strategies_file_ = "parser_strategies.json";
     static constexpr std::string_view practice_strategies_file_ = "practice_strategies.json";
 };
\ No newline at end of file